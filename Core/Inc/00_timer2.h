@@ -7,4 +7,7 @@ typedef void (*timer_cb_t)(void);
 void timer2_run(void);
 void tim2_register_callback(timer_cb_t cb);
 void tim2_unregister_all(void);
+void tim2_schedule(uint32_t due_ms, timer_cb_t cb);
+void tim2_cancel(timer_cb_t cb);
+void tim2_advance(uint32_t ms);
 uint32_t get_tim2_ms(void);
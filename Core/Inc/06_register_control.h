@@ -1 +1,2 @@
 void gpio_register_run(void);
+void gpio_register_wfe_run(void);
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include "07_traffic_fsm.h"
+
+typedef struct {
+	uint32_t refreshes;   // 직전 표시 구간의 TM1637 갱신 횟수
+	uint32_t span_ms;     // 직전 표시 구간 길이
+	uint32_t total;       // 누적 갱신 횟수
+} tdisplay_stats_t;
+
+void tdisplay_init(void);
+void tdisplay_show(tl_display_t display, uint32_t phase_end_ms);
+void tdisplay_brightness(uint8_t brightness);
+void tdisplay_poll(void);
+void tdisplay_get_stats(tdisplay_stats_t *stats);
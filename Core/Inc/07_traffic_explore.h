@@ -0,0 +1,20 @@
+#pragma once
+
+// 신호등 FSM 상태 공간 전수 탐색. FSM 코어만 사용하므로 호스트에서도 컴파일된다.
+
+#include <stdint.h>
+
+// 방문 집합 크기 (2의 거듭제곱). 기본값은 타깃 RAM 기준이고 호스트 빌드(host/)는 -D로 키운다
+#ifndef EXPLORE_CAPACITY
+#define EXPLORE_CAPACITY 1024
+#endif
+
+typedef struct {
+	uint32_t states;        // 방문한 상태 수
+	uint32_t transitions;   // 시도한 (상태, 입력, 시간 구간) 조합 수
+	uint32_t violations;    // 불변식 위반 수
+	uint32_t first_bad;     // 첫 위반 상태 키 (위반이 없으면 0)
+	uint8_t overflow;       // 방문 집합이 가득 참
+} explore_result_t;
+
+void traffic_explore_run(explore_result_t *result);
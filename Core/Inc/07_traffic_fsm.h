@@ -0,0 +1,73 @@
+#pragma once
+
+// 신호등 FSM 코어. HAL 의존성이 없어 호스트에서도 그대로 컴파일된다.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GREEN_MS 3000
+#define YELLOW_MS 1000
+#define RED_MS 2000
+
+#define NIGHT_BLINK_MS 1000
+#define NIGHT_BLINKS 6
+
+// step 입력 비트
+#define TL_IN_BUTTON     0x01  // B1 야간 요청 (6회 점멸 후 복귀)
+#define TL_IN_PLAN_DAY   0x02  // 스케줄: 주간 플랜
+#define TL_IN_PLAN_NIGHT 0x04  // 스케줄: 야간 점멸 플랜
+
+// 램프 비트
+#define TL_LAMP_GREEN  0x01
+#define TL_LAMP_YELLOW 0x02
+#define TL_LAMP_RED    0x04
+
+typedef enum {
+    MODE_DAY = 0,
+    MODE_NIGHT
+} traffic_mode_t;
+
+typedef enum {
+    DAY_GREEN = 0,
+    DAY_YELLOW,
+    DAY_RED
+} day_state_t;
+
+typedef enum {
+	PLAN_DAY = 0,
+	PLAN_NIGHT
+} traffic_plan_t;
+
+typedef enum {
+	TL_DISP_COUNTDOWN = 0,
+	TL_DISP_BLANK,
+	TL_DISP_EIGHTS
+} tl_display_t;
+
+// FSM 출력. 하드웨어 반영은 호출하는 쪽에서 한다.
+typedef struct {
+	uint8_t lamps;
+	uint8_t display;
+	uint16_t countdown_ds;  // 남은 시간 (0.1초 단위)
+} traffic_out_t;
+
+typedef struct {
+	traffic_plan_t plan;
+	traffic_mode_t mode;
+	day_state_t day_state;
+	uint32_t state_start_ms;
+	uint32_t last_blink_ms;
+	uint8_t blink_count;
+	traffic_out_t out;
+} traffic_fsm_t;
+
+void traffic_fsm_init(traffic_fsm_t *fsm, uint32_t now);
+void traffic_fsm_step(traffic_fsm_t *fsm, uint32_t now, uint8_t inputs);
+uint32_t traffic_fsm_next_deadline(const traffic_fsm_t *fsm, uint32_t now);
+uint32_t traffic_fsm_phase_ms(day_state_t state);
+
+static inline bool traffic_out_equal(const traffic_out_t *a, const traffic_out_t *b)
+{
+	return a->lamps == b->lamps && a->display == b->display
+	    && a->countdown_ds == b->countdown_ds;
+}
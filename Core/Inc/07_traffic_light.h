@@ -3,4 +3,7 @@
 #define YELLOW_LED_PIN  GPIO_PIN_8
 #define RED_LED_PIN     GPIO_PIN_6
 
+// 야간 플랜의 BAM 램프 밝기 상한 (0~255). 주간은 조도 단계를 그대로 따른다
+#define NIGHT_LAMP_LEVEL 48
+
 void traffic_light_run(void);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+// 링버퍼 크기 (2의 거듭제곱)
+#define TLOG_CAPACITY 256
+
+typedef enum {
+	TLOG_EV_PHASE = 1,     // 낮 상태 변경, payload: day_state
+	TLOG_EV_BUTTON,        // 버튼 요청, payload: 1 수락 / 0 디바운스로 무시
+	TLOG_EV_NIGHT_ENTER,   // 야간 모드 진입, payload: 진입 직전 day_state
+	TLOG_EV_NIGHT_EXIT,    // 야간 모드 종료, payload: blink_count
+	TLOG_EV_PLAN,          // 스케줄 플랜 변경, payload: traffic_plan_t
+} tlog_event_t;
+
+// 8바이트 레코드. USART2로 그대로 덤프된다.
+typedef struct {
+	uint32_t tick_ms;
+	uint8_t  event;
+	uint8_t  seq;          // 기록 순번 하위 8비트 (덮어쓰기 검출용)
+	uint16_t payload;
+} tlog_record_t;
+
+void tlog_init(void);
+void tlog_write(uint8_t event, uint16_t payload);
+void tlog_dump(void);
+uint32_t tlog_bench_cycles(void);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "07_traffic_fsm.h"
+
+// 기록 가능한 입력 이벤트 수
+#define TREC_CAPACITY 256
+
+// 기록된 입력 (틱은 기록 시작 기준 상대값)
+typedef struct {
+	uint32_t tick;
+	uint8_t inputs;     // TL_IN_* 비트
+	uint8_t reserved[3];
+} trec_input_t;
+
+typedef struct {
+	uint32_t changes;   // 출력 변화 횟수
+	uint32_t hash;      // 출력 트레이스 해시 (FNV-1a)
+} trace_sum_t;
+
+void trec_begin(uint32_t start_tick);
+void trec_input(uint32_t tick, uint8_t inputs);
+void trec_output(uint32_t tick, const traffic_out_t *out);
+void trec_end(uint32_t end_tick);
+bool trec_active(void);
+
+void trace_sum_init(trace_sum_t *sum);
+void trace_sum_add(trace_sum_t *sum, uint32_t tick, const traffic_out_t *out);
+
+void treplay_run(const trec_input_t *inputs, size_t count,
+                 uint32_t start_tick, uint32_t end_tick, trace_sum_t *sum);
+void treplay_init(void);
+void treplay_report(void);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include "07_traffic_fsm.h"
+#include "rtc_time.h"
+
+typedef struct {
+	uint16_t minute;        // 0시 기준 분 (0~1439)
+	traffic_plan_t plan;
+} schedule_entry_t;
+
+// 스케줄이 쓰는 시계. 타깃은 RTC(07_traffic_schedule_rtc.c), 호스트 테스트는 가짜 시계
+typedef struct {
+	void (*get)(rtc_time_t *t);
+	// 매일 hour:minute:00에 cb를 부른다. 다시 걸면 이전 알람은 없어진다
+	void (*set_alarm)(uint8_t hour, uint8_t minute, void (*cb)(void));
+} schedule_clock_t;
+
+void schedule_init(void);
+void schedule_start(const schedule_clock_t *clock);
+void schedule_resync(void);
+uint8_t schedule_take_input(void);
+traffic_plan_t schedule_plan_at(uint16_t minute_of_day);
+uint16_t schedule_next_boundary(uint16_t minute_of_day);
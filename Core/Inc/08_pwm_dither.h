@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+// 디더 패턴 한 패스 길이 (PWM 주기 수). 16비트 목표를 1000 x 64 = 64000 단계로 나눈다
+#define PWM_DITHER_LEN 64
+// 스펙트럼에서 보고하는 최대 빈 수
+#define PWM_DITHER_MAX_BINS 8
+
+typedef struct {
+	uint16_t bin;        // k -> 주파수 k * 1000 / PWM_DITHER_LEN Hz
+	uint32_t amp_mcnt;   // 진폭, CCR 카운트의 1/1000 단위
+} pwm_dither_bin_t;
+
+typedef struct {
+	uint32_t sum;               // 패스 전체 CCR 합 (평균 = sum / PWM_DITHER_LEN)
+	int32_t error_ppm;          // 목표 대비 평균 듀티 오차 (풀스케일 ppm)
+	uint16_t ccr_min;
+	uint16_t ccr_max;           // 리플 peak-to-peak = max - min
+	uint8_t bin_count;
+	pwm_dither_bin_t bins[PWM_DITHER_MAX_BINS];   // 진폭 큰 순
+} pwm_dither_report_t;
+
+void pwm_dither_build(uint32_t *table, uint16_t len, uint16_t duty16);
+void pwm_dither_analyze(const uint32_t *table, uint16_t len, uint16_t duty16, pwm_dither_report_t *report);
+uint32_t pwm_dither_levels(uint16_t len, int *monotonic);
+void pwm_dither_run(void);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 분주(divider)로 늘린 샘플을 담는 RAM 버퍼 크기
+#define PWM_WAVE_MAX_SAMPLES 1024
+
+typedef struct {
+	uint32_t cr;          // DMA1_Stream1 CR
+	uint32_t ndtr;        // 현재 패스에서 남은 전송 수
+	uint32_t par;
+	uint32_t m0ar;
+	uint32_t length;      // 스트리밍 중인 테이블 길이
+	uint32_t passes;      // 시작 후 끝난 패스 수 (TC)
+	uint32_t transfers;   // 시작 후 DMA 전송 수 (끝난 패스 + 지금 패스의 length - ndtr)
+	uint32_t swaps;       // 테이블 교체 횟수
+} pwm_wave_status_t;
+
+void pwm_wave_init(void);
+bool pwm_wave_load(const uint32_t *table, uint16_t len, uint16_t divider);
+void pwm_wave_stop(void);
+void pwm_wave_get_status(pwm_wave_status_t *status);
+void pwm_wave_dma_irq(void);
+void pwm_wave_run(void);
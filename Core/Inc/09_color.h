@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include "pwm_lut.h"
+
+// 색상환 한 바퀴 = 6구간 x 256
+#define COLOR_HUE_MAX 1536
+
+// CH4(W)는 PA3 = USART2 RX라서 켜면 콘솔 입력을 쓸 수 없다 (출력은 가능)
+#define COLOR_USE_W_CHANNEL 0
+
+typedef enum {
+	COLOR_R = 0,   // TIM2_CH1 PA15
+	COLOR_G,       // TIM2_CH2 PA1
+	COLOR_B,       // TIM2_CH3 PB10
+	COLOR_W,       // TIM2_CH4 PA3
+	COLOR_CHANNELS
+} color_channel_t;
+
+typedef struct {
+	uint16_t h;   // 0 ~ COLOR_HUE_MAX-1
+	uint8_t s;
+	uint8_t v;
+} hsv_t;
+
+typedef struct {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+	uint8_t w;
+} rgbw_t;
+
+typedef struct {
+	uint32_t int_cycles;     // 정수 변환 1회 평균 사이클
+	uint32_t float_cycles;   // float 기준 변환 1회 평균 사이클
+	uint8_t max_error;       // 채널 값 최대 오차 (0~255 단위)
+	uint32_t samples;
+} color_bench_t;
+
+rgbw_t color_hsv_to_rgbw(hsv_t hsv);
+void color_init(void);
+void color_set_gamma(color_channel_t ch, pwm_curve_t curve, uint8_t scale);
+void color_set(hsv_t hsv);
+void color_fade_to(hsv_t target, uint32_t duration_ms);
+void color_bench(color_bench_t *result);
+void color_run(void);
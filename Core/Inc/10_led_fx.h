@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+// 동시에 돌릴 수 있는 프로그램 수
+#define FX_MAX_PROG 8
+// UART로 올리는 프로그램 한 개의 최대 바이트 수
+#define FX_CODE_MAX 64
+
+// 명령 바이트 = (op << 4) | 출력 번호. 뒤따르는 인자는 리틀 엔디안
+typedef enum {
+	FX_OP_END = 0,     // [op]
+	FX_OP_SET,         // [op|out][level]
+	FX_OP_RAMP,        // [op|out][level][ms lo][ms hi]  현재 밝기에서 level까지 선형
+	FX_OP_WAIT,        // [op][ms lo][ms hi]
+	FX_OP_LOOP,        // [op][count][addr]  count번 반복 (0이면 무한). 유한 루프는 중첩 불가
+	FX_OP_BLINK,       // [op|out][n][half lo][half hi]  켜짐/꺼짐 half ms씩 n번
+	FX_OP_EVENT,       // [op][mask]  fx_post_event로 mask 비트가 올 때까지 대기
+} fx_op_t;
+
+typedef enum {
+	FX_OUT_LD2 = 0,    // PA5 (보드 LED, 켜짐/꺼짐)
+	FX_OUT_EXT,        // PC9 (외부 LED, 켜짐/꺼짐)
+	FX_OUT_PWM,        // TIM2_CH1 PA15 (감마 보정 밝기)
+	FX_OUT_COUNT
+} fx_out_t;
+
+#define FX_SET(out, level)          (FX_OP_SET << 4) | (out), (level)
+#define FX_RAMP(out, level, ms)     (FX_OP_RAMP << 4) | (out), (level), (ms) & 0xFF, (ms) >> 8
+#define FX_WAIT(ms)                 (FX_OP_WAIT << 4), (ms) & 0xFF, (ms) >> 8
+#define FX_LOOP(count, addr)        (FX_OP_LOOP << 4), (count), (addr)
+#define FX_BLINK(out, n, half)      (FX_OP_BLINK << 4) | (out), (n), (half) & 0xFF, (half) >> 8
+#define FX_EVENT(mask)              (FX_OP_EVENT << 4), (mask)
+#define FX_END                      (FX_OP_END << 4)
+
+int fx_load(uint8_t slot, const uint8_t *code, uint8_t len);
+void fx_stop(uint8_t slot);
+void fx_post_event(uint8_t mask);
+void fx_tick(void);
+int fx_asm_line(uint8_t *code, uint8_t *len, const char *line);
+void fx_run(void);
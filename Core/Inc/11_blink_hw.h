@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+	BLINK_HW_LD2 = 0,   // PA5, 타이머 핀 기능이 없어 TIM1 + DMA2로 BSRR에 쓴다
+	BLINK_HW_RED,       // PC6 TIM3_CH1
+	BLINK_HW_YELLOW,    // PC8 TIM3_CH3
+	BLINK_HW_GREEN,     // PC9 TIM3_CH4 (EXT LED)
+	BLINK_HW_COUNT
+} blink_hw_pin_t;
+
+// 타이머 카운터 0.1ms 단위, ARR 16비트 -> 최대 주기
+#define BLINK_HW_MAX_PERIOD_MS 6553
+
+bool blink_hw_start(blink_hw_pin_t pin, uint16_t period_ms, uint16_t duty_ms);
+void blink_hw_stop(blink_hw_pin_t pin);
+void blink_hw_run(void);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 핑퐁 버퍼 전체 샘플 수 (반쪽씩 채운다)
+#define PCM_BUF_SAMPLES 256
+#define PCM_HALF_SAMPLES (PCM_BUF_SAMPLES / 2)
+
+// dst에 count개 샘플(0 ~ steps-1 CCR 값)을 채운다. 할당 없이 호출자 버퍼에만 쓴다
+typedef void (*pcm_fill_t)(uint32_t *dst, uint16_t count);
+
+typedef struct {
+	uint32_t rate_hz;        // 실제 샘플레이트 (PSC 반올림 반영)
+	uint32_t steps;          // 해상도 (ARR + 1)
+	uint32_t halves;         // 채운 반쪽 버퍼 수
+	uint32_t underruns;      // 채우기 전에 DMA가 다시 읽기 시작한 횟수
+	uint32_t late_max_us;    // 반쪽이 빈 뒤 채울 때까지 가장 오래 걸린 시간
+} pcm_stats_t;
+
+bool pcm_start(uint32_t rate_hz, uint32_t steps, pcm_fill_t fill);
+void pcm_stop(void);
+void pcm_service(void);
+void pcm_get_stats(pcm_stats_t *stats);
+void pcm_dma_irq(void);
+void pcm_run(void);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 캡처 입력은 PA1 = TIM5_CH2 (AF2). B1(PC13)을 재려면 PC13과 PA1을 점퍼로 잇는다
+// 엣지 종류(상승/하강)별 DMA 링 길이
+#define ICAP_RING_LEN 256
+
+typedef struct {
+	uint32_t t;         // TIM5 카운트 (84MHz = 약 11.9ns 단위, 51초마다 한 바퀴)
+	uint8_t rising;
+} icap_edge_t;
+
+typedef struct {
+	uint32_t edges;          // 읽어 간 엣지 수
+	uint32_t lost;           // 읽기 전에 링이 덮어써서 버린 엣지 수
+	uint32_t overcaptures;   // DMA가 CCR을 옮기기 전에 다음 캡처가 온 횟수
+} icap_stats_t;
+
+void icap_init(void);
+bool icap_read(icap_edge_t *edge);
+uint64_t icap_ticks_to_ns(uint32_t ticks);
+void icap_get_stats(icap_stats_t *stats);
+void icap_dma_irq(uint8_t ring);
+void icap_run(void);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 자극 출력 PB8 = TIM10_CH1 (AF3). PB8과 B1(PC13)을 점퍼로 이어야 한다
+#define LAT_STIM_PORT GPIOB
+#define LAT_STIM_PIN  GPIO_PIN_8
+
+// 변형마다 자극 횟수 (TIM10 한 주기 = 65536클럭 = 약 780us에 한 번)
+#define LAT_TRIALS 500
+
+typedef enum {
+	LAT_IDLE,
+	LAT_POLL,     // 메인 루프에서 핀 레벨 확인
+	LAT_EXTI,     // EXTI ISR에서 바로 LED
+	LAT_DEFER,    // ISR은 표시만, LED는 메인 루프
+} lat_mode_t;
+
+typedef struct {
+	uint32_t count;
+	uint32_t min, median, p99, max;   // 버튼 엣지 -> LED 엣지 (CPU 사이클)
+	uint32_t missed;
+} lat_result_t;
+
+void latency_measure(lat_mode_t mode, uint32_t work_us, uint32_t pulse_us, lat_result_t *result);
+void latency_run(void);
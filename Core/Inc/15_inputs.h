@@ -0,0 +1,3 @@
+#pragma once
+
+void inputs_run(void);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+// 조도 센서(LDR 분압)는 PA0 = ADC1_IN0. 밝을수록 값이 크다
+#define AMBIENT_LEVELS 8
+#define AMBIENT_BAND (4096 / AMBIENT_LEVELS)
+#define AMBIENT_HYST 96
+// 평균을 읽고 단계를 다시 정하는 주기
+#define AMBIENT_PERIOD_MS 100
+
+typedef void (*ambient_cb_t)(uint8_t level);
+
+typedef struct {
+	uint16_t raw_avg;     // DMA 버퍼 평균
+	uint16_t filtered;    // 시간 평균 (EMA)
+	uint8_t level;        // 0 ~ AMBIENT_LEVELS-1
+	uint32_t changes;
+	uint32_t load_ppm;    // 서비스가 쓴 CPU 비율 (백만분율)
+} ambient_status_t;
+
+uint8_t ambient_level_step(uint8_t level, uint16_t light);
+uint16_t ambient_filter(uint16_t filtered, uint16_t sample);
+uint8_t ambient_lamp_level(void);
+void ambient_init(ambient_cb_t cb);
+void ambient_get_status(ambient_status_t *status);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+#include "main.h"
+
+// 8비트 밝기 = 비트 평면 8개
+#define BAM_PLANES 8
+
+typedef struct {
+	uint32_t plane[BAM_PLANES];   // 평면마다 BSRR에 쓸 워드
+	uint8_t level[16];            // 핀 번호별 밝기
+	uint16_t pins;                // 관리하는 핀 마스크
+} bam_frame_t;
+
+void bam_frame_build(bam_frame_t *frame, uint16_t pins);
+void bam_frame_set(bam_frame_t *frame, uint16_t pins, uint8_t level);
+
+void bam_init(GPIO_TypeDef *port, uint16_t pins);
+void bam_set(uint16_t pins, uint8_t level);
+void bam_bench(uint32_t *full_cycles, uint32_t *incr_cycles);
@@ -0,0 +1,91 @@
+#pragma once
+
+// Cortex-M4 비트 밴드: 한 비트를 별칭 주소의 워드 하나로 읽고 쓴다
+//
+// SRAM 0x20000000~0x200FFFFF -> 0x22000000~, 주변장치 0x40000000~0x400FFFFF -> 0x42000000~.
+// 별칭에 쓰면 버스가 그 비트만 바꾸는 읽기-수정-쓰기를 한 번에 해서, 그 사이에
+// ISR이 끼어들 수 없다. 그래서 임계 구역이나 LDREX/STREX 없이 한 비트를 원자적으로 바꾼다.
+// F411의 SRAM(128KB)과 APB/AHB1 주변장치(GPIO 포함)는 모두 이 범위 안에 있다.
+// AHB2(USB OTG) 이후 주소와 플래시, 스택 밖의 CCM 같은 곳은 안 된다.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "reg.h"
+
+#define BITBAND_SRAM_BASE    0x20000000UL
+#define BITBAND_PERIPH_BASE  0x40000000UL
+#define BITBAND_REGION_SIZE  0x00100000UL
+#define BITBAND_ALIAS_OFFSET 0x02000000UL
+
+// 주소의 비트 bit에 해당하는 별칭 워드. addr은 비트 밴드 영역 안이어야 한다
+REG_INLINE volatile uint32_t *bb_alias(volatile const void *addr, uint32_t bit)
+{
+	uint32_t a = (uint32_t)addr;
+	uint32_t region = a & 0xF0000000UL;
+
+	a += bit >> 3;
+	bit &= 7U;
+	return (volatile uint32_t *)(region + BITBAND_ALIAS_OFFSET + ((a - region) << 5) + (bit << 2));
+}
+
+REG_INLINE bool bb_in_region(volatile const void *addr)
+{
+	uint32_t a = (uint32_t)addr;
+
+	return (a - BITBAND_SRAM_BASE < BITBAND_REGION_SIZE) || (a - BITBAND_PERIPH_BASE < BITBAND_REGION_SIZE);
+}
+
+REG_INLINE void bb_set(volatile void *addr, uint32_t bit)
+{
+	*bb_alias(addr, bit) = 1U;
+}
+
+REG_INLINE void bb_clear(volatile void *addr, uint32_t bit)
+{
+	*bb_alias(addr, bit) = 0U;
+}
+
+REG_INLINE void bb_write(volatile void *addr, uint32_t bit, bool on)
+{
+	*bb_alias(addr, bit) = on;
+}
+
+REG_INLINE bool bb_test(volatile const void *addr, uint32_t bit)
+{
+	return *bb_alias(addr, bit) != 0U;
+}
+
+// ISR과 메인 루프 사이 신호용 플래그 32개. 반드시 SRAM에 있는 변수여야 한다
+typedef struct {
+	volatile uint32_t bits;
+} flagset_t;
+
+REG_INLINE void flag_raise(flagset_t *fs, uint32_t n)
+{
+	bb_set(&fs->bits, n);
+}
+
+REG_INLINE void flag_clear(flagset_t *fs, uint32_t n)
+{
+	bb_clear(&fs->bits, n);
+}
+
+REG_INLINE bool flag_test(const flagset_t *fs, uint32_t n)
+{
+	return bb_test(&fs->bits, n);
+}
+
+// 서 있으면 내리고 true. 그 사이 다시 올라온 신호는 이번 것과 합쳐진다
+REG_INLINE bool flag_take(flagset_t *fs, uint32_t n)
+{
+	if (!bb_test(&fs->bits, n)) {
+		return false;
+	}
+	bb_clear(&fs->bits, n);
+	return true;
+}
+
+REG_INLINE uint32_t flag_pending(const flagset_t *fs)
+{
+	return fs->bits;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "main.h"
+
+// 버튼 수 (상태를 32비트 마스크 하나로 들고 다닌다)
+#define BUTTON_MAX 32
+// 적분기 상한. 1ms 샘플이 이만큼 같은 쪽으로 쌓여야 상태가 바뀐다
+#define BUTTON_DEBOUNCE_MS 8
+#define BUTTON_LONG_MS     800
+#define BUTTON_REPEAT_MS   150
+// 짧게 눌렀다 뗀 뒤 이 안에 다시 누르면 더블 클릭
+#define BUTTON_DOUBLE_MS   300
+// 이벤트 큐 길이 (2의 거듭제곱)
+#define BUTTON_QUEUE_LEN   32
+
+typedef enum {
+	BUTTON_PRESS,
+	BUTTON_RELEASE,
+	BUTTON_LONG,      // BUTTON_LONG_MS 이상 누르고 있음 (한 번)
+	BUTTON_REPEAT,    // 길게 누른 뒤 BUTTON_REPEAT_MS마다
+	BUTTON_DOUBLE,    // 두 번째 누름에서 PRESS 다음에 온다
+} button_ev_type_t;
+
+typedef struct {
+	uint8_t id;
+	uint8_t type;     // button_ev_type_t
+	uint32_t ms;
+} button_event_t;
+
+void button_init(void);
+int button_add(GPIO_TypeDef *port, uint16_t pin, bool active_low);
+bool button_get(button_event_t *ev);
+bool button_is_pressed(uint8_t id);
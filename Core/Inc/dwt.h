@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+#include "main.h"
+
+// DWT 사이클 카운터 (성능 측정용)
+static inline void dwt_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t dwt_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+// 사이클 -> 나노초
+static inline uint32_t dwt_cycles_to_ns(uint32_t cycles)
+{
+	return (uint32_t)(((uint64_t)cycles * 1000000000ULL) / SystemCoreClock);
+}
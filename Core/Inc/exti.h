@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "main.h"
+
+// EXTI 벡터별로 묶인 GPIO 라인
+#define EXTI_LINES_0      0x0001U
+#define EXTI_LINES_1      0x0002U
+#define EXTI_LINES_2      0x0004U
+#define EXTI_LINES_3      0x0008U
+#define EXTI_LINES_4      0x0010U
+#define EXTI_LINES_9_5    0x03E0U
+#define EXTI_LINES_15_10  0xFC00U
+
+// pin은 GPIO_PIN_x 하나, ctx는 등록할 때 준 값 그대로
+typedef void (*exti_handler_t)(uint16_t pin, void *ctx);
+
+typedef struct {
+	exti_handler_t handler;
+	void *ctx;
+} exti_slot_t;
+
+// 라인마다 쌓아 두는 엣지 시각 수 (2의 거듭제곱)
+#define EXTI_STAMP_LEN 16
+
+typedef struct {
+	uint32_t count;      // 링에 넣은 시각 수
+	uint32_t dropped;    // 링이 차서 버린 시각 수
+	uint32_t overflows;  // 링이 가득 찬 횟수 (연달아 버린 구간 하나를 1로 센다)
+	uint32_t pending;    // 아직 꺼내지 않은 수
+} exti_stamp_stats_t;
+
+void exti_register(uint16_t pin, exti_handler_t handler, void *ctx);
+exti_slot_t exti_get(uint16_t pin);
+void exti_dispatch(uint32_t lines);
+void exti_stamp_enable(uint16_t pin, bool on);
+bool exti_stamp_get(uint16_t pin, uint32_t *cycles);
+void exti_stamp_stats(uint16_t pin, exti_stamp_stats_t *stats);
+void exti_bench(uint32_t *hal_one, uint32_t *table_one, uint32_t *stamp_one, uint32_t *hal_all, uint32_t *table_all);
+void exti_bench_init(void);
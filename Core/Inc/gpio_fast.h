@@ -0,0 +1,46 @@
+#pragma once
+
+// HAL_GPIO_WritePin/TogglePin/ReadPin 대신 쓰는 인라인 GPIO
+//
+// 인자는 HAL과 같은 (포트, GPIO_PIN_x 마스크)라 그대로 바꿔 끼울 수 있다.
+// 포트와 핀이 상수면 BSRR 저장 하나로 끝나고 assert_param이나 분기가 없다.
+// 토글도 ODR 읽기-수정-쓰기가 아니라 BSRR 한 번으로 써서, 그 사이 ISR이
+// 같은 포트의 다른 핀을 바꿔도 덮어쓰지 않는다.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "reg.h"
+
+REG_INLINE void gpio_set(GPIO_TypeDef *port, uint16_t pins)
+{
+	port->BSRR = pins;
+}
+
+REG_INLINE void gpio_clear(GPIO_TypeDef *port, uint16_t pins)
+{
+	port->BSRR = (uint32_t)pins << 16;
+}
+
+REG_INLINE void gpio_write(GPIO_TypeDef *port, uint16_t pins, bool on)
+{
+	port->BSRR = on ? pins : (uint32_t)pins << 16;
+}
+
+// mask 안의 핀을 value의 같은 비트로 한 번에 맞춘다
+REG_INLINE void gpio_write_mask(GPIO_TypeDef *port, uint16_t mask, uint16_t value)
+{
+	port->BSRR = ((uint32_t)(~value & mask) << 16) | (value & mask);
+}
+
+REG_INLINE void gpio_toggle(GPIO_TypeDef *port, uint16_t pins)
+{
+	uint32_t odr = port->ODR;
+
+	port->BSRR = ((odr & pins) << 16) | (~odr & pins);
+}
+
+// pins 중 하나라도 High면 true
+REG_INLINE bool gpio_read(GPIO_TypeDef *port, uint16_t pins)
+{
+	return (port->IDR & pins) != 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+// 인터럽트 우선순위 표와 BASEPRI 임계 구역
+//
+// 우선순위 그룹 4(선점 4비트, 서브 0비트). 숫자가 작을수록 높고, 높은 IRQ는 낮은 IRQ의
+// 핸들러 도중에도 들어온다(중첩). 모든 HAL_NVIC_SetPriority는 아래 이름으로만 쓴다.
+//
+//   레벨  이름                 IRQ               이유
+//   0     IRQ_PRIO_PROBE       TIM11 (bench)     cs_enter로 막을 수 없는 자리. priobench 탐침만 쓴다
+//   1     IRQ_PRIO_CAPTURE     DMA1 Stream2/4    icap 링 바퀴 수. 반 바퀴 안에 못 돌면 개수가 틀린다
+//   2     IRQ_PRIO_EXTI        EXTI0~15          버튼/지연 측정 엣지. 응답 시간이 곧 측정값
+//   3     IRQ_PRIO_STREAM      DMA1 Stream1/7    pwm_wave, pcm 반쪽 버퍼 채우기
+//   3     IRQ_PRIO_SCAN        TIM4              port_scan 10kHz 포트 스캔. 짧아서 스트림과 같은 레벨
+//   4     IRQ_PRIO_SYSTICK     SysTick           TIM2 작업 안의 HAL_GetTick 타임아웃이 멈추지 않게 TIM2 위
+//   5     IRQ_PRIO_TICK        TIM2              1ms 틱, 콜백과 예약 작업
+//                                                  pcm 재생 중에는 DMA1 Stream7(레벨 3)이 tim2_advance로 대신 돌린다
+//   6     IRQ_PRIO_RTC         RTC Alarm         초 단위라 늦어도 된다
+//   7     IRQ_PRIO_LOAD        TIM9 (bench)      priobench 부하
+//
+// 임계 구역은 공유 자원마다 천장을 정해 두고 그 값까지만 BASEPRI로 막는다. 천장은 그 자원을
+// 만지는 가장 높은 IRQ 레벨이고, 그보다 높은 IRQ는 구역 안에서도 그대로 들어온다.
+// 자원을 새 IRQ에서 만지게 되면 아래 천장도 같이 고쳐야 한다.
+
+#include <stdint.h>
+#include "reg.h"
+
+#define IRQ_PRIO_PROBE    0U
+#define IRQ_PRIO_CAPTURE  1U
+#define IRQ_PRIO_EXTI     2U
+#define IRQ_PRIO_STREAM   3U
+#define IRQ_PRIO_SCAN     3U
+#define IRQ_PRIO_SYSTICK  4U
+#define IRQ_PRIO_TICK     5U
+#define IRQ_PRIO_RTC      6U
+#define IRQ_PRIO_LOAD     7U
+
+// 자원별 천장 (메인 루프 + 괄호 안 IRQ가 공유).
+// TIM2 콜백/작업이 만지는 자원은 tim2_advance를 부르는 DMA1 Stream7까지 막아야 하므로 STREAM
+#define CS_TIM2_JOBS     IRQ_PRIO_STREAM   // 00 예약 작업 표 (TIM2, DMA1 Stream7)
+#define CS_FX_PROGS      IRQ_PRIO_STREAM   // 10 fx 슬롯 (TIM2, DMA1 Stream7)
+#define CS_FX_EVENTS     IRQ_PRIO_EXTI     // 10 fx 이벤트 비트 (TIM2 소비, fx_post_event는 EXTI에서도)
+#define CS_COLOR_FADE    IRQ_PRIO_STREAM   // 09 페이드 상태 (TIM2, DMA1 Stream7)
+#define CS_BUTTON_TABLE  IRQ_PRIO_STREAM   // button 포트/핀 표 (TIM2 샘플링, DMA1 Stream7)
+#define CS_AMBIENT_LOAD  IRQ_PRIO_STREAM   // ambient 부하 누적과 상태 (TIM2 작업, DMA1 Stream7)
+#define CS_EXT_LED       IRQ_PRIO_EXTI     // 05 외부 LED 끝 시각 (EXTI, TIM2)
+#define CS_EXTI_SLOTS    IRQ_PRIO_EXTI     // exti 핸들러 표 (EXTI)
+#define CS_ICAP_RING     IRQ_PRIO_CAPTURE  // icap NDTR과 바퀴 수 (DMA1 Stream2/4)
+#define CS_WAVE_COUNT    IRQ_PRIO_STREAM   // 08 끝난 패스 수와 전송 수 (DMA1 Stream1)
+#define CS_SCAN_TABLE    IRQ_PRIO_SCAN     // port_scan 포트/구독자 표 (TIM4)
+
+// ceiling 이하 IRQ를 막고 이전 BASEPRI를 돌려준다. ceiling은 1 이상이어야 한다(0은 BASEPRI 끄기).
+// __set_BASEPRI_MAX는 더 높일 때만 써지므로 안쪽 구역이 바깥 구역의 마스크를 풀지 않는다
+REG_INLINE uint32_t cs_enter(uint32_t ceiling)
+{
+	uint32_t basepri = __get_BASEPRI();
+
+	__set_BASEPRI_MAX(ceiling << (8U - __NVIC_PRIO_BITS));
+	__ISB();
+	return basepri;
+}
+
+REG_INLINE void cs_exit(uint32_t basepri)
+{
+	__set_BASEPRI(basepri);
+}
+
+// priobench 모드
+typedef enum {
+	PRIO_BENCH_IDLE,     // 탐침만
+	PRIO_BENCH_BASEPRI,  // TIM9 부하 + 메인 루프가 CS_TIM2_JOBS 구역을 반복
+	PRIO_BENCH_PRIMASK,  // TIM9 부하 + 같은 길이를 __disable_irq로
+	PRIO_BENCH_MODES,
+} prio_bench_mode_t;
+
+typedef struct {
+	uint32_t count;
+	uint32_t avg, max;   // TIM11 업데이트 -> 핸들러 첫 줄 (CPU 사이클)
+	uint32_t nested;     // TIM9 핸들러 도중에 들어간 횟수
+	uint32_t load;       // TIM9 핸들러 실행 횟수
+} prio_bench_t;
+
+void irq_prio_probe_irq(void);
+void irq_prio_load_irq(void);
+void irq_prio_bench(uint32_t section_us, prio_bench_t result[PRIO_BENCH_MODES]);
+void irq_prio_bench_init(void);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "main.h"
+
+// 스캔 주기 (TIM4 업데이트). 13의 icapbench도 TIM4를 쓰므로 같이 돌리지 않는다
+#define PORT_SCAN_HZ 10000U
+// 스캔하는 포트 GPIOA, GPIOB, GPIOC (핀 48개)
+#define PORT_SCAN_PORTS 3
+#define PORT_SCAN_MAX_SUB 8
+
+// pin은 이번 스캔에서 바뀐 GPIO_PIN_x 하나, level은 바뀐 뒤 레벨. TIM4 ISR에서 불린다
+typedef void (*port_scan_handler_t)(GPIO_TypeDef *port, uint16_t pin, bool level, void *ctx);
+
+typedef struct {
+	uint32_t scans;
+	uint32_t changes;       // 구독자에게 넘긴 비트 수
+	uint32_t cycles_last;   // 스캔 한 번 (ISR 전체, CPU 사이클)
+	uint32_t cycles_avg;    // 최근 1024번 평균
+	uint32_t cycles_max;
+	uint32_t inputs;        // 구독된 핀 수
+} port_scan_stats_t;
+
+void port_scan_init(void);
+int port_scan_subscribe(GPIO_TypeDef *port, uint16_t pins, port_scan_handler_t handler, void *ctx);
+void port_scan_get_stats(port_scan_stats_t *stats);
+void port_scan_irq(void);
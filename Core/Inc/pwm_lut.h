@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+// 밝기 100% 일 때 CCR 값 (htim2.Init.Period + 1). PWM1 모드에서 CCR > ARR 이면 항상 켜짐
+#define PWM_LUT_FULL 1000U
+#define PWM_LUT_LEVELS 256
+
+typedef enum {
+	PWM_CURVE_GAMMA22 = 0,   // 감마 2.2
+	PWM_CURVE_SINE,          // 사인 ease-in-out
+	PWM_CURVE_CUBIC,         // 3차 ease-in-out
+	PWM_CURVE_COUNT
+} pwm_curve_t;
+
+// 컴파일 타임에 생성되어 플래시에 놓이는 테이블
+extern const uint16_t pwm_lut[PWM_CURVE_COUNT][PWM_LUT_LEVELS];
+
+// 논리 밝기 0~255 -> CCR (테이블 한 번 읽기)
+static inline uint16_t pwm_lut_ccr(pwm_curve_t curve, uint8_t level)
+{
+	return pwm_lut[curve][level];
+}
+
+void pwm_lut_bench(uint32_t *lut_cycles, uint32_t *powf_cycles);
@@ -0,0 +1,111 @@
+#pragma once
+
+// 레지스터 필드와 핀을 이름으로 다루는 헤더 전용 계층
+//
+// 필드는 (위치, 폭)으로 적고 값은 REG_VAL로 만든다. 한 레지스터의 여러 필드는
+// 마스크와 값을 OR로 모아 reg_modify 한 번(읽기 1, 쓰기 1)으로 바꾼다.
+// 핀은 PIN_LD2처럼 "포트, 번호" 두 인자로 펼쳐지는 매크로라서 상수로 넘기면
+// 주소와 시프트가 컴파일 때 정해지고 pin_set은 STR 하나가 된다.
+// CMSIS 장치 헤더(stm32f4xx.h)만 쓰고 HAL은 쓰지 않는다.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+#define REG_INLINE static inline __attribute__((always_inline))
+
+// 필드 마스크와 값 (폭은 1~31)
+#define REG_MASK(pos, width)    ((((1UL << (width)) - 1UL)) << (pos))
+#define REG_VAL(pos, width, v)  (((uint32_t)(v) << (pos)) & REG_MASK(pos, width))
+
+// clear 비트를 지우고 set 비트를 켠다. 읽기-수정-쓰기 한 번
+REG_INLINE void reg_modify(volatile uint32_t *reg, uint32_t clear, uint32_t set)
+{
+	*reg = (*reg & ~clear) | set;
+}
+
+REG_INLINE uint32_t reg_field(uint32_t value, uint32_t pos, uint32_t width)
+{
+	return (value >> pos) & ((1UL << width) - 1UL);
+}
+
+// GPIO 필드 값
+typedef enum {
+	PIN_MODE_INPUT  = 0,
+	PIN_MODE_OUTPUT = 1,
+	PIN_MODE_AF     = 2,
+	PIN_MODE_ANALOG = 3,
+} pin_mode_t;
+
+typedef enum {
+	PIN_PULL_NONE = 0,
+	PIN_PULL_UP   = 1,
+	PIN_PULL_DOWN = 2,
+} pin_pull_t;
+
+typedef enum {
+	PIN_SPEED_LOW    = 0,
+	PIN_SPEED_MEDIUM = 1,
+	PIN_SPEED_FAST   = 2,
+	PIN_SPEED_HIGH   = 3,
+} pin_speed_t;
+
+// 핀 n의 필드. MODER/PUPDR/OSPEEDR은 2비트, AFR은 레지스터 두 개에 4비트씩
+#define GPIO_MASK2(n)      REG_MASK((n) * 2U, 2U)
+#define GPIO_VAL2(n, v)    REG_VAL((n) * 2U, 2U, v)
+#define GPIO_MASK_AF(n)    REG_MASK(((n) & 7U) * 4U, 4U)
+#define GPIO_VAL_AF(n, v)  REG_VAL(((n) & 7U) * 4U, 4U, v)
+
+// 보드 핀 (포트, 번호)
+#define PIN_LD2  GPIOA, 5U
+#define PIN_B1   GPIOC, 13U
+
+// GPIO 포트 클럭 비트 (GPIOA = 0, GPIOB = 1, ...). PIN_CLOCK(PIN_LD2)처럼 핀으로도 쓴다
+#define GPIO_PORT_INDEX(port)  (((uint32_t)(port) - GPIOA_BASE) / (GPIOB_BASE - GPIOA_BASE))
+#define PIN_CLOCK(...)         PIN_CLOCK_(__VA_ARGS__)
+#define PIN_CLOCK_(port, n)    (1UL << GPIO_PORT_INDEX(port))
+
+REG_INLINE void port_clock_enable(uint32_t port_mask)
+{
+	reg_modify(&RCC->AHB1ENR, 0, port_mask);
+	// 클럭을 켠 직후 첫 접근이 늦게 반영되지 않도록 한 번 읽어 둔다
+	(void)RCC->AHB1ENR;
+}
+
+REG_INLINE void pin_set(GPIO_TypeDef *port, const uint32_t n)
+{
+	port->BSRR = 1UL << n;
+}
+
+REG_INLINE void pin_clear(GPIO_TypeDef *port, const uint32_t n)
+{
+	port->BSRR = 1UL << (n + 16U);
+}
+
+REG_INLINE void pin_write(GPIO_TypeDef *port, const uint32_t n, bool on)
+{
+	port->BSRR = on ? (1UL << n) : (1UL << (n + 16U));
+}
+
+REG_INLINE bool pin_read(GPIO_TypeDef *port, const uint32_t n)
+{
+	return (port->IDR >> n) & 1UL;
+}
+
+// 모드와 풀업/다운을 한 번에. 레지스터마다 읽기-수정-쓰기 한 번
+REG_INLINE void pin_config(GPIO_TypeDef *port, const uint32_t n, pin_mode_t mode, pin_pull_t pull)
+{
+	reg_modify(&port->MODER, GPIO_MASK2(n), GPIO_VAL2(n, mode));
+	reg_modify(&port->PUPDR, GPIO_MASK2(n), GPIO_VAL2(n, pull));
+}
+
+REG_INLINE void pin_speed(GPIO_TypeDef *port, const uint32_t n, pin_speed_t speed)
+{
+	reg_modify(&port->OSPEEDR, GPIO_MASK2(n), GPIO_VAL2(n, speed));
+}
+
+REG_INLINE void pin_af(GPIO_TypeDef *port, const uint32_t n, uint32_t af)
+{
+	reg_modify(&port->AFR[n >> 3], GPIO_MASK_AF(n), GPIO_VAL_AF(n, af));
+	reg_modify(&port->MODER, GPIO_MASK2(n), GPIO_VAL2(n, PIN_MODE_AF));
+}
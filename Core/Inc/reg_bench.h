@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+#include "dwt.h"
+
+#define REG_BENCH_ROUNDS 1000
+
+// 같은 루프에서 본문만 바꿔 재고, 빈 루프 시간을 뺀 한 번당 사이클
+#define REG_BENCH(out, body)                                  \
+	do {                                                      \
+		uint32_t start_ = dwt_cycles();                       \
+		for (uint32_t i_ = 0; i_ < REG_BENCH_ROUNDS; ++i_) {  \
+			body;                                             \
+			__asm volatile("" ::: "memory");                  \
+		}                                                     \
+		(out) = dwt_cycles() - start_;                        \
+	} while (0)
+
+// 헤더만 있는 레지스터 계층의 콘솔 벤치 명령을 등록한다
+void reg_bench_init(void);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rtc_time.h"
+
+typedef void (*rtc_alarm_cb_t)(void);
+
+void rtc_clock_init(void);
+void rtc_clock_get(rtc_time_t *t);
+bool rtc_clock_set(const rtc_time_t *t);
+void rtc_clock_set_alarm(uint8_t hour, uint8_t minute, rtc_alarm_cb_t cb);
+void rtc_alarm_irq_handler(void);
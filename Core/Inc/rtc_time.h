@@ -0,0 +1,17 @@
+#pragma once
+
+// 달력 시각과 날짜 계산. HAL 의존성이 없어 호스트(host/)에서도 그대로 컴파일된다.
+
+#include <stdint.h>
+
+typedef struct {
+	uint8_t year;     // 2000년 기준 (0~99)
+	uint8_t month;
+	uint8_t day;
+	uint8_t hour;
+	uint8_t minute;
+	uint8_t second;
+} rtc_time_t;
+
+uint8_t rtc_days_in_month(uint8_t year, uint8_t month);
+void rtc_time_add_seconds(rtc_time_t *t, uint32_t seconds);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*console_cmd_t)(const char *args);
+
+void console_register(const char *name, console_cmd_t handler);
+void console_poll(void);
+void console_write(const void *data, size_t len);
+void console_printf(const char *format, ...);
@@ -1,8 +1,11 @@
 #include "main.h"
 #include "00_timer2.h"
+#include "irq_prio.h"
 
 // TIM2에 들어가야하는 기능 수.
 #define MAX_CALLBACK 3
+// 한 번만 실행되는 예약 작업 수
+#define MAX_JOB 4
 
 volatile uint32_t tim2_tick_ms = 0;
 extern TIM_HandleTypeDef htim2;
@@ -11,6 +14,13 @@ typedef void (*timer_cb_t)(void);
 static timer_cb_t tim2_callbacks[MAX_CALLBACK];
 static size_t tim2_cb_count = 0;
 
+typedef struct {
+	timer_cb_t cb;
+	uint32_t due_ms;
+} tim2_job_t;
+
+static volatile tim2_job_t tim2_jobs[MAX_JOB];
+
 void timer2_run(void)
 {
   HAL_TIM_Base_Start_IT(&htim2);
@@ -30,19 +40,84 @@ void tim2_unregister_all(void)
 	tim2_cb_count = 0;
 }
 
+// due_ms 틱에 cb를 한 번 실행. 같은 cb가 이미 예약돼 있으면 시각만 바꾼다.
+// cb 안에서 자기 자신을 다시 예약할 수 있다.
+void tim2_schedule(uint32_t due_ms, timer_cb_t cb)
+{
+	uint32_t cs = cs_enter(CS_TIM2_JOBS);
+	int free_slot = -1;
+
+	for (int i = 0; i < MAX_JOB; ++i)
+	{
+		if (tim2_jobs[i].cb == cb)
+		{
+			tim2_jobs[i].due_ms = due_ms;
+			cs_exit(cs);
+			return;
+		}
+		if (tim2_jobs[i].cb == NULL && free_slot < 0) {
+			free_slot = i;
+		}
+	}
+
+	if (free_slot >= 0)
+	{
+		tim2_jobs[free_slot].due_ms = due_ms;
+		tim2_jobs[free_slot].cb = cb;
+	}
+	cs_exit(cs);
+}
+
+void tim2_cancel(timer_cb_t cb)
+{
+	uint32_t cs = cs_enter(CS_TIM2_JOBS);
+
+	for (int i = 0; i < MAX_JOB; ++i)
+	{
+		if (tim2_jobs[i].cb == cb) {
+			tim2_jobs[i].cb = NULL;
+		}
+	}
+	cs_exit(cs);
+}
+
+
+static void tim2_tick(void)
+{
+	tim2_tick_ms++;
+
+	for (size_t i = 0; i < tim2_cb_count; ++i) {
+		tim2_callbacks[i]();
+	}
+
+	for (int i = 0; i < MAX_JOB; ++i)
+	{
+		timer_cb_t job = tim2_jobs[i].cb;
+
+		if (job != NULL && (int32_t)(tim2_tick_ms - tim2_jobs[i].due_ms) >= 0)
+		{
+			tim2_jobs[i].cb = NULL;
+			job();
+		}
+	}
+}
 
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
   if (htim->Instance == TIM2)
   {
-  	tim2_tick_ms++;
-
-  	for (size_t i = 0; i < tim2_cb_count; ++i) {
-  		tim2_callbacks[i]();
-  	}
+  	tim2_tick();
   }
 }
 
+// TIM2 주기를 다른 용도로 바꿔 업데이트 인터럽트를 끈 동안, 지난 ms만큼 틱을 몰아서 진행
+void tim2_advance(uint32_t ms)
+{
+	while (ms-- > 0) {
+		tim2_tick();
+	}
+}
+
 
 uint32_t get_tim2_ms(void)
 {
@@ -1,11 +1,12 @@
 #include "01_led_delay.h"
+#include "gpio_fast.h"
 #include "main.h"
 
 void led_delay_run(void)
 {
   while (1)
   {
-    HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin);
+    gpio_toggle(LD2_GPIO_Port, LD2_Pin);
     HAL_Delay(500);
   }
 }
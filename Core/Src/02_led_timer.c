@@ -1,6 +1,7 @@
 #include "main.h"
 #include "00_timer2.h"
 #include "02_led_timer.h"
+#include "gpio_fast.h"
 
 static uint32_t led_counter = 0;
 
@@ -10,7 +11,7 @@ static void led_blink_interrupt(void)
   led_counter++;
 
   if (led_counter >= 500) {
-  	HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin);
+  	gpio_toggle(LD2_GPIO_Port, LD2_Pin);
   	led_counter = 0;
   }
 }
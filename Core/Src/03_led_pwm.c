@@ -1,23 +1,25 @@
 #include "03_led_pwm.h"
 #include "main.h"
+#include "pwm_lut.h"
 
 extern TIM_HandleTypeDef htim2;
 
+// 논리 밝기를 감마 2.2 테이블로 보정해서 눈에 고르게 밝아지도록 한다
 void led_pwm_run(void)
 {
   HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
 
   while (1)
   {
-    for (uint32_t duty = 0; duty <= htim2.Init.Period; duty += 50)
+    for (int32_t level = 0; level < PWM_LUT_LEVELS; level += 8)
     {
-      __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, duty);
+      __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, pwm_lut_ccr(PWM_CURVE_GAMMA22, (uint8_t)level));
       HAL_Delay(10);
     }
 
-    for (int32_t duty = htim2.Init.Period; duty >= 0; duty -= 50)
+    for (int32_t level = PWM_LUT_LEVELS - 1; level >= 0; level -= 8)
     {
-      __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, duty);
+      __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, pwm_lut_ccr(PWM_CURVE_GAMMA22, (uint8_t)level));
       HAL_Delay(10);
     }
   }
@@ -2,21 +2,22 @@
 
 #include <stdbool.h>
 #include "04_polling.h"
+#include "gpio_fast.h"
 #include "main.h"
 
 void led_polling_run()
 {
 	while(1) {
-		if(HAL_GPIO_ReadPin(B1_GPIO_Port, B1_Pin) == GPIO_PIN_RESET)
+		if(!gpio_read(B1_GPIO_Port, B1_Pin))
 		{
-			HAL_GPIO_WritePin(EXT_GPIO_Port, EXT_LED_Pin, GPIO_PIN_SET);
+			gpio_set(EXT_GPIO_Port, EXT_LED_Pin);
 			HAL_Delay(2000);
-			HAL_GPIO_WritePin(EXT_GPIO_Port, EXT_LED_Pin, GPIO_PIN_RESET);
+			gpio_clear(EXT_GPIO_Port, EXT_LED_Pin);
 		}
 
-		HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_SET);
+		gpio_set(LD2_GPIO_Port, LD2_Pin);
 		HAL_Delay(2000);
-		HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_RESET);
+		gpio_clear(LD2_GPIO_Port, LD2_Pin);
 		HAL_Delay(1000);
 	}
 }
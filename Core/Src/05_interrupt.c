@@ -3,46 +3,56 @@
 #include <stdbool.h>
 #include "00_timer2.h"
 #include "05_interrupt.h"
+#include "bitband.h"
+#include "exti.h"
+#include "irq_prio.h"
+#include "gpio_fast.h"
 #include "main.h"
 
-static volatile bool ext_led_active = false;
+// EXTI 핸들러와 TIM2 작업이 함께 쓰는 플래그
+static flagset_t led_flags;
+#define EXT_LED_ACTIVE 0
 static volatile uint32_t ext_led_end = 0;
 
 static void ext_led_task(void);
 static void internal_led_task(void);
+static void on_button(uint16_t pin, void *ctx);
 
 
 void led_interrupt_run(void)
 {
 	tim2_register_callback(internal_led_task);
 	tim2_register_callback(ext_led_task);
+	exti_register(B1_Pin, on_button, NULL);
 }
 
 
-// 버튼 EXTI 콜백
-//void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
-//{
-//  if (GPIO_Pin == B1_Pin)
-//  {
-//  	HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_RESET);
-//  	HAL_GPIO_WritePin(EXT_GPIO_Port, EXT_LED_Pin, GPIO_PIN_SET);
-//
-//  	ext_led_active = true;
-//    ext_led_end = get_tim2_ms() + 2000;
-//  }
-//}
+// 버튼 EXTI 핸들러
+static void on_button(uint16_t pin, void *ctx)
+{
+	gpio_clear(LD2_GPIO_Port, LD2_Pin);
+	gpio_set(EXT_GPIO_Port, EXT_LED_Pin);
+
+	flag_raise(&led_flags, EXT_LED_ACTIVE);
+	ext_led_end = get_tim2_ms() + 2000;
+}
 
 static void ext_led_task(void)
 {
-	if (!ext_led_active) {
+	uint32_t cs;
+
+	if (!flag_test(&led_flags, EXT_LED_ACTIVE)) {
 		return;
 	}
 
+	// 끝 시각을 읽고 끄는 사이에 버튼 EXTI가 새로 켜면 그 누름이 지워지지 않게 막는다
+	cs = cs_enter(CS_EXT_LED);
 	if ((int32_t)(get_tim2_ms() - ext_led_end) >= 0)
 	{
-		HAL_GPIO_WritePin(EXT_GPIO_Port, EXT_LED_Pin, GPIO_PIN_RESET);
-		ext_led_active = false;
+		gpio_clear(EXT_GPIO_Port, EXT_LED_Pin);
+		flag_clear(&led_flags, EXT_LED_ACTIVE);
 	}
+	cs_exit(cs);
 }
 
 static void internal_led_task(void)
@@ -50,14 +60,14 @@ static void internal_led_task(void)
 	static uint32_t next_toggle = 0;
 	static bool led_on = false;
 
-	if (ext_led_active) {
+	if (flag_test(&led_flags, EXT_LED_ACTIVE)) {
 			return;
 	}
 
 	if ((int32_t)(get_tim2_ms() - next_toggle) >= 0)
 	{
 		led_on = !led_on;
-		HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, led_on ? GPIO_PIN_SET : GPIO_PIN_RESET);
+		gpio_write(LD2_GPIO_Port, LD2_Pin, led_on);
 
 		next_toggle = get_tim2_ms() + (led_on ? 2000 : 1000);
 	}
@@ -1,52 +1,188 @@
 #include <stdint.h>
+#include <stdio.h>
 #include "06_register_control.h"
+#include "reg.h"
 
-// 베이스 주소
-#define GPIOA_BASE 0x40020000UL
-#define GPIOC_BASE 0x40020800UL
-#define RCC_BASE 0x40023800UL
+// 주소, 시프트, 필드 폭은 reg.h가 핀 번호로 계산한다 (손으로 쓴 0x3U << (5 * 2) 대신)
 
-// RCC 레지스터
-#define RCC_AHB1ENR  (*(volatile uint32_t *)(RCC_BASE  + 0x30))
+void gpio_register_run(void)
+{
+	// RCC에서 GPIOA, GPIOC 클럭 Enable 설정 (AHB1ENR 읽기-수정-쓰기 한 번)
+	port_clock_enable(PIN_CLOCK(PIN_LD2) | PIN_CLOCK(PIN_B1));
+
+	// 내부 LED 설정
+	pin_config(PIN_LD2, PIN_MODE_OUTPUT, PIN_PULL_NONE);
+
+	// PC13 내부 버튼 설정
+	pin_config(PIN_B1, PIN_MODE_INPUT, PIN_PULL_NONE);
 
-// GPIOA 레지스터
-#define GPIOA_MODER (*(volatile uint32_t *)(GPIOA_BASE + 0x00))
-#define GPIOA_OTYPER (*(volatile uint32_t *)(GPIOA_BASE + 0x04))
-#define GPIOA_PUPDR (*(volatile uint32_t *)(GPIOA_BASE + 0x0C))
-#define GPIOA_BSRR (*(volatile uint32_t *)(GPIOA_BASE + 0x18))
+	while(1)
+	{
+		pin_write(PIN_LD2, !pin_read(PIN_B1));
+	}
+}
 
-// GPIOC 레지스터
-#define GPIOC_MODER (*(volatile uint32_t *)(GPIOC_BASE + 0x00))
-#define GPIOC_PUPDR (*(volatile uint32_t *)(GPIOC_BASE + 0x0C))
-#define GPIOC_IDR (*(volatile uint32_t *)(GPIOC_BASE + 0x10))
+// ---------------------------------------------------------------------------
+// 같은 버튼 -> LD2 거울을 WFE로: 버튼이 가만히 있으면 코어는 잠들어 있다
+//
+// EXTI13을 인터럽트가 아닌 이벤트(EMR)로 양쪽 엣지에 걸어 두면 엣지마다 WFE에서 깨기만 하고
+// ISR은 돌지 않는다. 깨면 IDR을 읽어 BSRR에 쓰고 다시 잔다.
+// TIM5(32비트, 코어 클럭과 같은 속도, 잠든 동안에도 돈다)로 잠든 시간과 깬 뒤 LED까지 걸린
+// 클럭을 재고, 버튼을 뗄 때마다 USART2(PA2)로 레지스터만 써서 출력한다.
+// 깨어나는 하드웨어 지연 자체는 엣지 시각을 알 수 없어 포함되지 않는다.
+// TIM5는 84MHz에서 51초, HSI 16MHz에서 268초마다 한 바퀴 돌고 버튼은 그보다 오래 가만히
+// 있을 수 있다. 그래서 업데이트(UIE)를 켜고 NVIC 줄은 끈 채 SEVONPEND로 WFE만 깨워서
+// 바퀴를 세고, 시각은 (바퀴 << 32) | CNT 64비트로 쓴다. 이렇게 깬 것은 버튼 깸으로 세지 않는다.
 
-#define LD2_PIN 5
-#define BTN_PIN 13
+#define WFE_USART_BAUD 115200
 
+typedef struct {
+	uint32_t wakes;          // WFE에서 깬 횟수
+	uint32_t spurious;       // 깼는데 버튼 상태가 그대로였던 횟수
+	uint32_t resp_min;       // 깬 뒤 BSRR 쓰기까지 (TIM5 클럭)
+	uint32_t resp_max;
+	uint64_t resp_sum;
+	uint64_t asleep;         // WFE 안에 있던 시간 (TIM5 클럭)
+} wfe_stats_t;
 
-void gpio_register_run(void)
+static volatile wfe_stats_t wfe_stats;
+static uint32_t tim5_laps;   // TIM5가 한 바퀴 돈 횟수
+
+static void bare_uart_init(void)
 {
-	// RCC에서 GPIOA, GPIOC 클럭 Enable 설정
-	RCC_AHB1ENR |= (1U << 0);
-	RCC_AHB1ENR |= (1U << 2);
+	uint32_t pclk1 = SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
 
-	// 내부 LED 설정
-	GPIOA_MODER &= ~(0x3U << (LD2_PIN * 2));
-	GPIOA_MODER |= (0x1U << (LD2_PIN * 2));
+	reg_modify(&RCC->APB1ENR, 0, RCC_APB1ENR_USART2EN);
+	(void)RCC->APB1ENR;
+	pin_af(GPIOA, 2U, 7U);   // PA2 = USART2_TX
 
-	// PC13 내부 버튼 설정
-	GPIOC_MODER &= ~(0x3U << (BTN_PIN * 2));
-	GPIOC_PUPDR &= ~(0x3U << (BTN_PIN * 2));
+	USART2->CR1 = 0;
+	USART2->BRR = (pclk1 + WFE_USART_BAUD / 2) / WFE_USART_BAUD;
+	USART2->CR1 = USART_CR1_TE | USART_CR1_UE;
+}
 
-	while(1)
+static void bare_uart_puts(const char *s)
+{
+	while (*s)
+	{
+		while (!(USART2->SR & USART_SR_TXE)) {}
+		USART2->DR = (uint8_t)*s++;
+	}
+	while (!(USART2->SR & USART_SR_TC)) {}
+}
+
+// 64비트 TIM5 시각. 한 바퀴 안에 한 번은 불려야 한다 (잠든 동안은 UIF가 깨워 준다)
+static uint64_t tim5_now(void)
+{
+	uint32_t cnt = TIM5->CNT;
+
+	if (TIM5->SR & TIM_SR_UIF)
 	{
-		uint32_t btn = (GPIOC_IDR >> BTN_PIN) & 0x1;
+		// 방금 돌았다. UIF 전에 읽은 CNT일 수 있으니 지우고 다시 읽는다
+		TIM5->SR = ~TIM_SR_UIF;
+		NVIC_ClearPendingIRQ(TIM5_IRQn);   // 다음 UIF가 다시 대기 상태로 바뀌어야 SEVONPEND가 깨운다
+		tim5_laps++;
+		cnt = TIM5->CNT;
+	}
+	return ((uint64_t)tim5_laps << 32) | cnt;
+}
+
+static void wfe_report(uint64_t now, uint64_t start)
+{
+	char buf[112];
+	uint64_t total = now - start;
+	uint32_t awake_resp = wfe_stats.wakes - wfe_stats.spurious;
+
+	snprintf(buf, sizeof(buf), "wfe: %lu wakes (%lu spurious), resp %lu/%lu/%lu clk, asleep %lu.%lu%%\r\n",
+	         (unsigned long)wfe_stats.wakes, (unsigned long)wfe_stats.spurious,
+	         (unsigned long)wfe_stats.resp_min,
+	         (unsigned long)(awake_resp ? wfe_stats.resp_sum / awake_resp : 0),
+	         (unsigned long)wfe_stats.resp_max,
+	         (unsigned long)(wfe_stats.asleep * 100 / (total ? total : 1)),
+	         (unsigned long)(wfe_stats.asleep * 1000 / (total ? total : 1) % 10));
+	bare_uart_puts(buf);
+}
+
+void gpio_register_wfe_run(void)
+{
+	uint64_t start;
+	uint32_t last_level;
+
+	port_clock_enable(PIN_CLOCK(PIN_LD2) | PIN_CLOCK(PIN_B1));
+	pin_config(PIN_LD2, PIN_MODE_OUTPUT, PIN_PULL_NONE);
+	pin_config(PIN_B1, PIN_MODE_INPUT, PIN_PULL_NONE);
+	bare_uart_init();
+
+	// TIM5: 분주 없이 자유 실행
+	reg_modify(&RCC->APB1ENR, 0, RCC_APB1ENR_TIM5EN);
+	(void)RCC->APB1ENR;
+	TIM5->PSC = 0;
+	TIM5->ARR = 0xFFFFFFFFU;
+	TIM5->EGR = TIM_EGR_UG;
+	TIM5->SR = 0;
+	TIM5->DIER = TIM_DIER_UIE;
+	NVIC_DisableIRQ(TIM5_IRQn);
+	NVIC_ClearPendingIRQ(TIM5_IRQn);
+	TIM5->CR1 = TIM_CR1_CEN;
+
+	// EXTI13 <- PC13, 양쪽 엣지, 인터럽트 마스크는 끄고 이벤트 마스크만 켠다
+	reg_modify(&RCC->APB2ENR, 0, RCC_APB2ENR_SYSCFGEN);
+	(void)RCC->APB2ENR;
+	reg_modify(&SYSCFG->EXTICR[3], SYSCFG_EXTICR4_EXTI13, SYSCFG_EXTICR4_EXTI13_PC);
+	reg_modify(&EXTI->IMR, EXTI_IMR_MR13, 0);
+	reg_modify(&EXTI->RTSR, 0, EXTI_RTSR_TR13);
+	reg_modify(&EXTI->FTSR, 0, EXTI_FTSR_TR13);
+	reg_modify(&EXTI->EMR, 0, EXTI_EMR_MR13);
+
+	// 슬립(딥슬립 아님): 주변장치 클럭과 TIM5는 그대로 돈다. 꺼 둔 IRQ가 대기 상태가 되어도 깬다
+	reg_modify(&SCB->SCR, SCB_SCR_SLEEPDEEP_Msk, SCB_SCR_SEVONPEND_Msk);
 
-		if (btn == 0) {
-			GPIOA_BSRR = (1U << LD2_PIN);
+	wfe_stats.resp_min = UINT32_MAX;
+	last_level = pin_read(PIN_B1);
+	pin_write(PIN_LD2, !last_level);
+	start = tim5_now();
+
+	while (1)
+	{
+		uint64_t t_sleep = tim5_now();
+		uint64_t t_wake;
+		uint32_t laps = tim5_laps;
+		uint32_t t_led, level, resp;
+
+		__WFE();
+		t_wake = tim5_now();
+
+		level = pin_read(PIN_B1);
+		pin_write(PIN_LD2, !level);
+		t_led = TIM5->CNT;
+
+		wfe_stats.asleep += t_wake - t_sleep;
+		// TIM5가 돌아서 깬 것이면 버튼 깸으로 세지 않는다
+		if (tim5_laps != laps && level == last_level) {
+			continue;
 		}
-		else {
-			GPIOA_BSRR = (1U << (LD2_PIN + 16));
+		wfe_stats.wakes++;
+
+		// 이벤트 레지스터가 미리 서 있었거나 바운스가 이미 끝난 경우
+		if (level == last_level)
+		{
+			wfe_stats.spurious++;
+			continue;
+		}
+		last_level = level;
+
+		resp = t_led - (uint32_t)t_wake;
+		if (resp < wfe_stats.resp_min) {
+			wfe_stats.resp_min = resp;
+		}
+		if (resp > wfe_stats.resp_max) {
+			wfe_stats.resp_max = resp;
+		}
+		wfe_stats.resp_sum += resp;
+
+		// 뗄 때(High)만 출력한다. 출력하는 동안은 깨어 있는 시간으로 잡힌다
+		if (level) {
+			wfe_report(tim5_now(), start);
 		}
 	}
 }
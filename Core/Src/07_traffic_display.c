@@ -0,0 +1,161 @@
+// 신호등 TM1637 표시. 숫자가 바뀌는 시각에만 TIM2 예약 작업으로 갱신한다.
+// 작업은 그릴 내용만 정하고, 약 0.4ms 걸리는 비트뱅 전송은 메인 루프의 tdisplay_poll이 한다.
+// 그래야 같은 1ms 틱의 다른 콜백(button_tick, ambient 작업)이 밀리지 않는다.
+
+#include <stdio.h>
+#include "main.h"
+#include "00_timer2.h"
+#include "07_traffic_display.h"
+#include "bitband.h"
+#include "tm1637.h"
+#include "uart_console.h"
+
+extern tm1637_t seg;
+
+// 예약 작업(ISR)과 메인 루프가 공유. 메인 루프만 TM1637에 쓴다.
+static volatile uint8_t disp_kind = TL_DISP_BLANK;
+static volatile uint32_t disp_end_ms = 0;
+static volatile uint8_t disp_dirty = 0;
+
+// 작업이 정한 다음 화면과 밝기. 플래그를 올린 뒤 tdisplay_poll이 보낸다
+static flagset_t send_flags;
+#define SEND_DRAW       0
+#define SEND_BRIGHTNESS 1
+static volatile uint8_t draw_kind = TL_DISP_BLANK;
+static volatile uint32_t draw_ds = 0;
+static volatile uint8_t draw_brightness = 0;
+
+static uint32_t shown_ds = UINT32_MAX;
+static uint32_t span_start_ms = 0;
+static uint32_t span_refreshes = 0;
+static tdisplay_stats_t last_stats;
+
+static void tdisplay_cmd_stats(const char *args);
+
+static void display_countdown(uint32_t deciseconds)
+{
+    char buf[6];
+    uint32_t seconds     = deciseconds / 10;
+    uint32_t deci        = deciseconds % 10;
+
+    snprintf(buf, sizeof(buf), "%02lu.%1lu", (unsigned long)seconds, (unsigned long)deci);
+
+    if (buf[0] == '0')
+    {
+    	buf[0] = ' ';
+    }
+    tm1637_str(&seg, buf);
+}
+
+static void request_draw(uint8_t kind, uint32_t ds)
+{
+	draw_kind = kind;
+	draw_ds = ds;
+	flag_raise(&send_flags, SEND_DRAW);
+	span_refreshes++;
+	last_stats.total++;
+}
+
+// TIM2 예약 작업. 그릴 내용을 정하고 다음 숫자 변경 시각에 자신을 다시 예약한다.
+static void tdisplay_job(void)
+{
+	uint32_t now = get_tim2_ms();
+
+	if (disp_kind != TL_DISP_COUNTDOWN)
+	{
+		if (disp_dirty) {
+			request_draw(disp_kind, 0);
+		}
+		disp_dirty = 0;
+		return;
+	}
+
+	uint32_t remaining_ms = ((int32_t)(disp_end_ms - now) > 0) ? disp_end_ms - now : 0;
+	uint32_t ds = remaining_ms / 100;
+
+	if (disp_dirty || ds != shown_ds)
+	{
+		request_draw(TL_DISP_COUNTDOWN, ds);
+		shown_ds = ds;
+	}
+	disp_dirty = 0;
+
+	if (remaining_ms > 0)
+	{
+		// remaining_ms / 100 이 다음으로 바뀌는 틱
+		uint32_t next_ms = remaining_ms % 100 + 1;
+		tim2_schedule(now + ((next_ms < remaining_ms) ? next_ms : remaining_ms), tdisplay_job);
+	}
+}
+
+void tdisplay_init(void)
+{
+	console_register("disp", tdisplay_cmd_stats);
+}
+
+// 표시 종류나 카운트다운 구간이 바뀔 때만 메인 루프에서 호출
+void tdisplay_show(tl_display_t display, uint32_t phase_end_ms)
+{
+	uint32_t now = get_tim2_ms();
+
+	tim2_cancel(tdisplay_job);
+
+	last_stats.refreshes = span_refreshes;
+	last_stats.span_ms = now - span_start_ms;
+	span_refreshes = 0;
+	span_start_ms = now;
+
+	disp_kind = display;
+	disp_end_ms = phase_end_ms;
+	disp_dirty = 1;
+
+	tim2_schedule(now, tdisplay_job);
+}
+
+// TM1637 밝기(1~8). TIM2 작업에서 불러도 되고, 실제 전송은 tdisplay_poll이 한다
+void tdisplay_brightness(uint8_t brightness)
+{
+	draw_brightness = brightness;
+	flag_raise(&send_flags, SEND_BRIGHTNESS);
+}
+
+// 메인 루프에서 호출. 정해 둔 화면과 밝기를 TM1637로 보낸다.
+// 보내는 도중 작업이 새 화면을 정하면 플래그가 다시 서서 다음 호출에 그린다
+void tdisplay_poll(void)
+{
+	if (flag_take(&send_flags, SEND_BRIGHTNESS)) {
+		tm1637_brightness(&seg, draw_brightness);
+	}
+
+	if (flag_take(&send_flags, SEND_DRAW))
+	{
+		uint8_t kind = draw_kind;
+
+		if (kind == TL_DISP_COUNTDOWN) {
+			display_countdown(draw_ds);
+		}
+		else if (kind == TL_DISP_EIGHTS) {
+			tm1637_str(&seg, "88.88");
+		}
+		else {
+			tm1637_clear(&seg);
+		}
+	}
+}
+
+void tdisplay_get_stats(tdisplay_stats_t *stats)
+{
+	*stats = last_stats;
+}
+
+static void tdisplay_cmd_stats(const char *args)
+{
+	tdisplay_stats_t stats;
+
+	tdisplay_get_stats(&stats);
+	console_printf("disp: last span %lu refreshes in %lu ms (%lu.%lu/s), total %lu\r\n",
+	               (unsigned long)stats.refreshes, (unsigned long)stats.span_ms,
+	               (unsigned long)(stats.span_ms ? stats.refreshes * 1000UL / stats.span_ms : 0),
+	               (unsigned long)(stats.span_ms ? (stats.refreshes * 10000UL / stats.span_ms) % 10 : 0),
+	               (unsigned long)stats.total);
+}
@@ -0,0 +1,207 @@
+// 신호등 FSM 상태 공간 전수 탐색
+//
+// 상태는 step 직후의 FSM을 현재 틱 기준 상대 시간으로 정규화해 32비트 키로 묶는다.
+// 각 상태에서 모든 입력 조합을 세 시간 구간(다음 틱, 데드라인 직전, 데드라인)에
+// 넣어 보고, 도달한 상태마다 불변식을 검사한다.
+
+#include <stdbool.h>
+#include "07_traffic_explore.h"
+#include "07_traffic_fsm.h"
+
+#define EXPLORE_MASK (EXPLORE_CAPACITY - 1)
+#define INPUT_COMBOS 8   // TL_IN_* 3비트 조합
+
+// 32비트 랩어라운드 양쪽에서 FSM을 돌리기 위한 기준 틱
+#define WRAP_BASE ((uint32_t)0 - 2048U)
+
+_Static_assert((EXPLORE_CAPACITY & EXPLORE_MASK) == 0, "EXPLORE_CAPACITY must be a power of 2");
+
+// 키 + 1 저장 (0은 빈 슬롯)
+static uint32_t visited[EXPLORE_CAPACITY];
+static uint32_t queue[EXPLORE_CAPACITY];
+
+// 키 비트 배치
+#define KEY_ELAPSED(k)   ((k) & 0xFFF)
+#define KEY_COUNTDOWN(k) (((k) >> 12) & 0x1F)
+#define KEY_DISPLAY(k)   (((k) >> 17) & 0x3)
+#define KEY_LAMPS(k)     (((k) >> 19) & 0x7)
+#define KEY_BLINKS(k)    (((k) >> 22) & 0x7)
+#define KEY_DAY(k)       (((k) >> 25) & 0x3)
+#define KEY_MODE(k)      (((k) >> 27) & 0x1)
+#define KEY_PLAN(k)      (((k) >> 28) & 0x1)
+
+// 동작에 영향이 없는 필드는 0으로 맞춘다.
+// 낮: blink_count, last_blink_ms는 야간 진입 시 초기화됨
+// 밤: day_state, state_start_ms는 낮 복귀 시 초기화됨
+// 카운트다운 표시가 아닐 때 countdown_ds는 출력되지 않음
+static uint32_t pack(const traffic_fsm_t *fsm, uint32_t now)
+{
+	bool night = (fsm->mode == MODE_NIGHT);
+	uint32_t elapsed = now - (night ? fsm->last_blink_ms : fsm->state_start_ms);
+	uint32_t countdown = (fsm->out.display == TL_DISP_COUNTDOWN) ? fsm->out.countdown_ds : 0;
+
+	return (elapsed & 0xFFF)
+	     | ((countdown & 0x1F) << 12)
+	     | ((uint32_t)(fsm->out.display & 0x3) << 17)
+	     | ((uint32_t)(fsm->out.lamps & 0x7) << 19)
+	     | ((uint32_t)(night ? (fsm->blink_count & 0x7) : 0) << 22)
+	     | ((uint32_t)(night ? 0 : (fsm->day_state & 0x3)) << 25)
+	     | ((uint32_t)fsm->mode << 27)
+	     | ((uint32_t)fsm->plan << 28);
+}
+
+static void unpack(traffic_fsm_t *fsm, uint32_t key, uint32_t now)
+{
+	fsm->plan = (traffic_plan_t)KEY_PLAN(key);
+	fsm->mode = (traffic_mode_t)KEY_MODE(key);
+	fsm->day_state = (day_state_t)KEY_DAY(key);
+	fsm->blink_count = (uint8_t)KEY_BLINKS(key);
+	fsm->state_start_ms = now - ((fsm->mode == MODE_DAY) ? KEY_ELAPSED(key) : 0);
+	fsm->last_blink_ms = now - ((fsm->mode == MODE_NIGHT) ? KEY_ELAPSED(key) : 0);
+	fsm->out.lamps = (uint8_t)KEY_LAMPS(key);
+	fsm->out.display = (uint8_t)KEY_DISPLAY(key);
+	fsm->out.countdown_ds = (uint16_t)KEY_COUNTDOWN(key);
+}
+
+// 곱셈 해시의 윗비트를 아래로 섞어 용량이 커져도 마스크가 고르게 퍼지게 한다
+static uint32_t hash(uint32_t key)
+{
+	uint32_t h = key * 2654435761U;
+
+	return h ^ (h >> 16);
+}
+
+// 새로 추가되면 true
+static bool visit(uint32_t key, explore_result_t *result)
+{
+	uint32_t slot = hash(key) & EXPLORE_MASK;
+
+	for (uint32_t probe = 0; probe < EXPLORE_CAPACITY; ++probe)
+	{
+		if (visited[slot] == key + 1) {
+			return false;
+		}
+		if (visited[slot] == 0)
+		{
+			visited[slot] = key + 1;
+			queue[result->states++] = key;
+			return true;
+		}
+		slot = (slot + 1) & EXPLORE_MASK;
+	}
+
+	result->overflow = 1;
+	return false;
+}
+
+static uint8_t lamp_count(uint8_t lamps)
+{
+	return (uint8_t)(((lamps & TL_LAMP_GREEN) ? 1 : 0) + ((lamps & TL_LAMP_YELLOW) ? 1 : 0)
+	               + ((lamps & TL_LAMP_RED) ? 1 : 0));
+}
+
+static bool invariants_hold(const traffic_fsm_t *fsm, uint32_t now)
+{
+	if (fsm->mode == MODE_DAY)
+	{
+		// 낮에는 램프가 정확히 하나
+		if (lamp_count(fsm->out.lamps) != 1 || fsm->out.display != TL_DISP_COUNTDOWN) {
+			return false;
+		}
+		// 카운트다운은 현재 상태 길이를 넘지 않는다
+		if (fsm->out.countdown_ds * 100U > traffic_fsm_phase_ms(fsm->day_state)) {
+			return false;
+		}
+	}
+	else if (fsm->out.lamps & (TL_LAMP_GREEN | TL_LAMP_RED))
+	{
+		return false;
+	}
+
+	// step 직후 다음 데드라인은 항상 미래
+	return (int32_t)(traffic_fsm_next_deadline(fsm, now) - now) > 0;
+}
+
+static void check(const traffic_fsm_t *fsm, uint32_t now, explore_result_t *result)
+{
+	if (!invariants_hold(fsm, now))
+	{
+		if (result->violations++ == 0) {
+			result->first_bad = pack(fsm, now);
+		}
+	}
+}
+
+static void expand(uint32_t key, uint32_t base, explore_result_t *result)
+{
+	traffic_fsm_t fsm;
+	uint32_t deadline;
+	uint32_t when[3];
+
+	unpack(&fsm, key, base);
+	deadline = traffic_fsm_next_deadline(&fsm, base);
+
+	// 데드라인 직전까지는 입력 없이 출력이 바뀌면 안 된다
+	if (deadline - base > 1)
+	{
+		traffic_fsm_t quiet = fsm;
+		traffic_fsm_step(&quiet, deadline - 1, 0);
+		if (!traffic_out_equal(&quiet.out, &fsm.out))
+		{
+			if (result->violations++ == 0) {
+				result->first_bad = key;
+			}
+		}
+	}
+
+	when[0] = base + 1;
+	when[1] = deadline - 1;
+	when[2] = deadline;
+
+	for (uint8_t in = 0; in < INPUT_COMBOS; ++in)
+	{
+		for (int w = 0; w < 3; ++w)
+		{
+			// 같은 틱이거나 과거인 구간은 건너뛴다
+			if ((int32_t)(when[w] - base) <= 0 || (w > 0 && when[w] == when[w - 1])) {
+				continue;
+			}
+
+			traffic_fsm_t next = fsm;
+			traffic_fsm_step(&next, when[w], in);
+			result->transitions++;
+
+			check(&next, when[w], result);
+
+			// 다음 틱에서 시간만 흐른 상태는 데드라인 직전 구간과 같은 부류이므로
+			// 다시 펼치지 않는다 (펼치면 1ms마다 새 상태가 생김)
+			uint32_t next_key = pack(&next, when[w]);
+			if (w == 0 && (next_key & ~0xFFFU) == (key & ~0xFFFU)) {
+				continue;
+			}
+			visit(next_key, result);
+		}
+	}
+}
+
+void traffic_explore_run(explore_result_t *result)
+{
+	traffic_fsm_t fsm;
+	uint32_t head = 0;
+
+	for (uint32_t i = 0; i < EXPLORE_CAPACITY; ++i) {
+		visited[i] = 0;
+	}
+	*result = (explore_result_t){ 0 };
+
+	traffic_fsm_init(&fsm, WRAP_BASE);
+	check(&fsm, WRAP_BASE, result);
+	visit(pack(&fsm, WRAP_BASE), result);
+
+	while (head < result->states && !result->overflow)
+	{
+		// 기준 틱을 바꿔 가며 랩어라운드 전후를 모두 지나게 한다
+		uint32_t base = WRAP_BASE + (head * 37U) % 4096U;
+		expand(queue[head++], base, result);
+	}
+}
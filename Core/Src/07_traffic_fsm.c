@@ -0,0 +1,157 @@
+// 신호등 FSM 코어 (시간과 입력 비트만 받는 순수 로직)
+
+#include "07_traffic_fsm.h"
+
+static const uint8_t day_lamps[] = {
+	[DAY_GREEN]  = TL_LAMP_GREEN,
+	[DAY_YELLOW] = TL_LAMP_YELLOW,
+	[DAY_RED]    = TL_LAMP_RED,
+};
+
+uint32_t traffic_fsm_phase_ms(day_state_t state)
+{
+	switch (state)
+	{
+	case DAY_GREEN:
+		return GREEN_MS;
+	case DAY_YELLOW:
+		return YELLOW_MS;
+	case DAY_RED:
+	default:
+		return RED_MS;
+	}
+}
+
+static void enter_day_state(traffic_fsm_t *fsm, day_state_t state, uint32_t now)
+{
+	fsm->day_state = state;
+	fsm->state_start_ms = now;
+	fsm->out.lamps = day_lamps[state];
+	fsm->out.display = TL_DISP_COUNTDOWN;
+	fsm->out.countdown_ds = traffic_fsm_phase_ms(state) / 100;
+}
+
+static void enter_night(traffic_fsm_t *fsm, uint32_t now)
+{
+	fsm->mode = MODE_NIGHT;
+	fsm->blink_count = 0;
+	fsm->last_blink_ms = now;
+	fsm->out.lamps = TL_LAMP_YELLOW;
+	fsm->out.display = TL_DISP_EIGHTS;
+}
+
+void traffic_fsm_init(traffic_fsm_t *fsm, uint32_t now)
+{
+	fsm->plan = PLAN_DAY;
+	fsm->mode = MODE_DAY;
+	fsm->last_blink_ms = now;
+	fsm->blink_count = 0;
+	enter_day_state(fsm, DAY_GREEN, now);
+}
+
+static void day_fsm_run(traffic_fsm_t *fsm, uint32_t now)
+{
+	uint32_t elapsed_ms = now - fsm->state_start_ms;
+	uint32_t phase_ms = traffic_fsm_phase_ms(fsm->day_state);
+
+	if (elapsed_ms >= phase_ms)
+	{
+		switch (fsm->day_state)
+		{
+		case DAY_GREEN:
+			enter_day_state(fsm, DAY_YELLOW, now);
+			break;
+		case DAY_YELLOW:
+			enter_day_state(fsm, DAY_RED, now);
+			break;
+		case DAY_RED:
+			enter_day_state(fsm, DAY_GREEN, now);
+			break;
+		}
+		return;
+	}
+
+	fsm->out.countdown_ds = (phase_ms - elapsed_ms) / 100;
+}
+
+static void night_fsm_run(traffic_fsm_t *fsm, uint32_t now)
+{
+	if (now - fsm->last_blink_ms < NIGHT_BLINK_MS)
+	{
+		return;
+	}
+
+	fsm->last_blink_ms = now;
+
+	// 야간 플랜에서는 복귀하지 않고 계속 점멸
+	if (fsm->blink_count < NIGHT_BLINKS)
+	{
+		fsm->blink_count++;
+	}
+
+	if (fsm->blink_count >= NIGHT_BLINKS && fsm->plan == PLAN_DAY)
+	{
+		fsm->mode = MODE_DAY;
+		enter_day_state(fsm, DAY_GREEN, now);
+		return;
+	}
+
+	fsm->out.lamps ^= TL_LAMP_YELLOW;
+	fsm->out.display = (fsm->out.display == TL_DISP_EIGHTS) ? TL_DISP_BLANK : TL_DISP_EIGHTS;
+}
+
+// 1ms 틱마다 한 번씩 호출한다고 가정. inputs는 TL_IN_* 비트
+void traffic_fsm_step(traffic_fsm_t *fsm, uint32_t now, uint8_t inputs)
+{
+	if ((inputs & TL_IN_PLAN_NIGHT) && fsm->plan != PLAN_NIGHT)
+	{
+		fsm->plan = PLAN_NIGHT;
+		enter_night(fsm, now);
+	}
+	else if ((inputs & TL_IN_PLAN_DAY) && fsm->plan != PLAN_DAY)
+	{
+		fsm->plan = PLAN_DAY;
+		fsm->mode = MODE_DAY;
+		enter_day_state(fsm, DAY_GREEN, now);
+	}
+
+	if (inputs & TL_IN_BUTTON)
+	{
+		enter_night(fsm, now);
+	}
+
+	switch (fsm->mode)
+	{
+	case MODE_DAY:
+		day_fsm_run(fsm, now);
+		break;
+
+	case MODE_NIGHT:
+		night_fsm_run(fsm, now);
+		break;
+	}
+}
+
+// 입력이 없을 때 출력이 다음으로 바뀔 수 있는 틱.
+// 그 사이 틱의 step은 아무것도 바꾸지 않으므로 건너뛰어도 결과가 같다.
+uint32_t traffic_fsm_next_deadline(const traffic_fsm_t *fsm, uint32_t now)
+{
+	if (fsm->mode == MODE_NIGHT)
+	{
+		uint32_t elapsed_ms = now - fsm->last_blink_ms;
+		return (elapsed_ms >= NIGHT_BLINK_MS) ? now : now + (NIGHT_BLINK_MS - elapsed_ms);
+	}
+
+	uint32_t elapsed_ms = now - fsm->state_start_ms;
+	uint32_t phase_ms = traffic_fsm_phase_ms(fsm->day_state);
+
+	if (elapsed_ms >= phase_ms)
+	{
+		return now;
+	}
+
+	uint32_t remaining_ms = phase_ms - elapsed_ms;
+	uint32_t digit_ms = remaining_ms % 100 + 1;  // countdown_ds가 바뀌는 시점
+
+	return now + ((digit_ms < remaining_ms) ? digit_ms : remaining_ms);
+}
@@ -1,194 +1,219 @@
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdio.h>
 #include "07_traffic_light.h"
+#include "07_traffic_display.h"
+#include "07_traffic_explore.h"
+#include "07_traffic_fsm.h"
+#include "07_traffic_log.h"
+#include "07_traffic_replay.h"
+#include "07_traffic_schedule.h"
 #include "00_timer2.h"
+#include "ambient.h"
+#include "bam.h"
+#include "button.h"
+#include "dwt.h"
 #include "main.h"
-#include "tm1637.h"
+#include "uart_console.h"
 
-#define GREEN_MS 3000
-#define YELLOW_MS 1000
-#define RED_MS 2000
+static traffic_fsm_t fsm;
+static traffic_out_t shown;     // 마지막으로 하드웨어에 반영한 출력
+static uint32_t shown_phase_end = 0;
+static uint32_t fsm_tick = 0;   // FSM이 마지막으로 처리한 틱
 
-extern tm1637_t seg;
+static uint8_t shown_level = 0;   // 마지막으로 램프에 준 밝기
 
-typedef enum {
-    MODE_DAY = 0,
-    MODE_NIGHT
-} traffic_mode_t;
+static bool night_request = false;
+static int b1_id = -1;
 
-typedef enum {
-    DAY_GREEN = 0,
-    DAY_YELLOW,
-    DAY_RED
-} day_state_t;
-
-
-static traffic_mode_t mode = MODE_DAY;
-static day_state_t day_state = DAY_GREEN;
-
-static volatile bool night_request = false;
-static bool night_digit_display = false;
-
-static uint32_t state_start_ms = 0;
-static uint32_t last_blink_ms = 0;
-static uint8_t blink_count = 0;
-
-static void set_leds(uint8_t green, uint8_t yellow, uint8_t red)
+// 램프 밝기는 주변 조도를 따르고, 야간 플랜에서는 NIGHT_LAMP_LEVEL을 넘지 않는다
+static uint8_t lamp_level(void)
 {
-    HAL_GPIO_WritePin(LED_PORT, GREEN_LED_PIN,
-                      green ? GPIO_PIN_SET : GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(LED_PORT, YELLOW_LED_PIN,
-                      yellow ? GPIO_PIN_SET : GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(LED_PORT, RED_LED_PIN,
-                      red ? GPIO_PIN_SET : GPIO_PIN_RESET);
+	uint8_t level = ambient_lamp_level();
+
+	if (fsm.plan == PLAN_NIGHT && level > NIGHT_LAMP_LEVEL) {
+		level = NIGHT_LAMP_LEVEL;
+	}
+	return level;
 }
 
-static void display_countdown(uint32_t remaining_ms)
+// 램프는 BAM으로 밝기를 준다
+static void set_leds(uint8_t green, uint8_t yellow, uint8_t red, uint8_t level)
 {
-    char buf[4];
-    uint32_t deciseconds = remaining_ms / 100;
-    uint32_t seconds     = deciseconds / 10;
-    uint32_t deci        = deciseconds % 10;
-
-    sprintf(buf, "%02lu.%1lu", seconds, deci);
-
-    if (buf[0] == '0')
-    {
-    	buf[0] = ' ';
-    }
-    tm1637_str(&seg, buf);
+    bam_set(GREEN_LED_PIN, green ? level : 0);
+    bam_set(YELLOW_LED_PIN, yellow ? level : 0);
+    bam_set(RED_LED_PIN, red ? level : 0);
 }
 
-static void day_fsm_run(uint32_t now)
+// 램프는 바로 반영하고, 표시는 종류나 카운트다운 구간이 바뀔 때만 표시 작업에 넘긴다
+static void apply_outputs(const traffic_out_t *out, bool force)
 {
-	uint32_t elapsed_ms = now - state_start_ms;
-	uint32_t remaining_ms;
+	uint32_t phase_end = fsm.state_start_ms + traffic_fsm_phase_ms(fsm.day_state);
+	uint8_t level = lamp_level();
 
-	switch (day_state)
+	if (force || out->lamps != shown.lamps || level != shown_level)
 	{
-	case DAY_GREEN:
-		remaining_ms = (elapsed_ms < GREEN_MS) ? (GREEN_MS - elapsed_ms) : 0;
-		display_countdown(remaining_ms);
-
-			if (now - state_start_ms >= GREEN_MS)
-			{
-					day_state = DAY_YELLOW;
-					state_start_ms = now;
-					set_leds(0, 1, 0);
-			}
-			break;
-
-	case DAY_YELLOW:
-		remaining_ms = (elapsed_ms < YELLOW_MS) ? (YELLOW_MS - elapsed_ms) : 0;
-		display_countdown(remaining_ms);
-
-		if (now - state_start_ms >= YELLOW_MS)
-		{
-				day_state = DAY_RED;
-				state_start_ms = now;
-				set_leds(0, 0, 1);
-		}
-		break;
-
-	case DAY_RED:
-		remaining_ms = (elapsed_ms < RED_MS) ? (RED_MS - elapsed_ms) : 0;
-		display_countdown(remaining_ms);
+		set_leds(out->lamps & TL_LAMP_GREEN, out->lamps & TL_LAMP_YELLOW, out->lamps & TL_LAMP_RED, level);
+		shown_level = level;
+	}
 
-		if (now - state_start_ms >= RED_MS)
-		{
-				day_state = DAY_GREEN;
-				state_start_ms = now;
-				set_leds(1, 0, 0);
-		}
-		break;
+	if (force || out->display != shown.display
+	    || (out->display == TL_DISP_COUNTDOWN && phase_end != shown_phase_end))
+	{
+		tdisplay_show((tl_display_t)out->display, phase_end);
+		shown_phase_end = phase_end;
 	}
+
+	shown = *out;
 }
 
-static void night_fsm_run(uint32_t now)
+static void traffic_step(uint32_t now, uint8_t inputs)
 {
-	if (now - last_blink_ms >= 1000)
+	traffic_plan_t prev_plan = fsm.plan;
+	traffic_mode_t prev_mode = fsm.mode;
+	day_state_t prev_day = fsm.day_state;
+	traffic_out_t prev_out = fsm.out;
+
+	if (inputs)
 	{
-		last_blink_ms = now;
-		blink_count++;
+		trec_input(now, inputs);
+	}
 
-		if (blink_count >= 6)
-		{
-				return;
-		}
+	traffic_fsm_step(&fsm, now, inputs);
 
-		HAL_GPIO_TogglePin(LED_PORT, YELLOW_LED_PIN);
+	if (fsm.plan != prev_plan)
+	{
+		tlog_write(TLOG_EV_PLAN, fsm.plan);
+	}
 
-		if (night_digit_display)
+	if (fsm.mode != prev_mode)
+	{
+		if (fsm.mode == MODE_NIGHT)
 		{
-			night_digit_display = false;
-			tm1637_clear(&seg);
+			tlog_write(TLOG_EV_NIGHT_ENTER, prev_day);
 		}
 		else
 		{
-			night_digit_display = true;
-			tm1637_str(&seg, "88.88");
+			tlog_write(TLOG_EV_NIGHT_EXIT, fsm.blink_count);
+			tlog_write(TLOG_EV_PHASE, fsm.day_state);
 		}
 	}
+	else if ((inputs & TL_IN_BUTTON) && fsm.mode == MODE_NIGHT)
+	{
+		// 야간 점멸 중 재요청: 점멸 다시 시작
+		tlog_write(TLOG_EV_NIGHT_ENTER, 0xFF);
+	}
+	else if (fsm.mode == MODE_DAY && fsm.day_state != prev_day)
+	{
+		tlog_write(TLOG_EV_PHASE, fsm.day_state);
+	}
 
-	if (blink_count >= 6)
+	if (!traffic_out_equal(&fsm.out, &prev_out))
 	{
-		mode = MODE_DAY;
-		day_state = DAY_GREEN;
-		state_start_ms = now;
-		set_leds(1, 0, 0);
-		tm1637_clear(&seg);
-		night_digit_display = false;
-		return;
+		trec_output(now, &fsm.out);
 	}
 }
 
-void traffic_light_run(void)
+// 초록불부터 다시 시작하면서 입력 기록 시작. 현재 스케줄 플랜은 첫 입력으로 기록된다.
+static void traffic_cmd_rec(const char *args)
 {
-	uint32_t now;
+	traffic_fsm_init(&fsm, fsm_tick);
+	apply_outputs(&fsm.out, true);
+	tlog_write(TLOG_EV_PHASE, DAY_GREEN);
+	trec_begin(fsm_tick);
+	schedule_resync();
+}
 
-	set_leds(1, 0, 0);
-	state_start_ms = get_tim2_ms();
+static void traffic_cmd_replay(const char *args)
+{
+	trec_end(fsm_tick);
+	treplay_report();
+}
 
-	while (1)
-	{
-		now = get_tim2_ms();
+// FSM 코어 상태 공간 전수 탐색 결과와 처리 속도. 주 도구는 host/의 explore이고,
+// 이건 같은 탐색을 타깃 RAM에 맞춘 작은 방문 집합으로 돌려 본다
+static void traffic_cmd_explore(const char *args)
+{
+	explore_result_t result;
+	uint32_t start = dwt_cycles();
 
-		if (night_request)
-		{
-			night_request = false;
-			mode = MODE_NIGHT;
-			blink_count = 0;
-			last_blink_ms = now;
-			set_leds(0, 1, 0);
-			tm1637_str(&seg, "88.88");
-			night_digit_display = true;
-		}
+	traffic_explore_run(&result);
 
-		switch (mode)
-		{
-		case MODE_DAY:
-			day_fsm_run(now);
-			break;
+	uint32_t cycles = dwt_cycles() - start;
+	uint32_t us = dwt_cycles_to_ns(cycles) / 1000;
+
+	console_printf("explore: %lu states, %lu transitions, %lu violations (first %08lx)%s\r\n",
+	               (unsigned long)result.states, (unsigned long)result.transitions,
+	               (unsigned long)result.violations, (unsigned long)result.first_bad,
+	               result.overflow ? ", OVERFLOW" : "");
+	console_printf("explore: %lu us, %lu states/s\r\n", (unsigned long)us,
+	               (unsigned long)((uint64_t)result.states * SystemCoreClock / (cycles ? cycles : 1)));
+}
+
+// 조도 단계가 바뀌면 TIM2 작업 안에서 불린다. TM1637은 0(꺼짐)을 빼고 1~8 단계 (전송은 메인 루프)
+static void on_ambient(uint8_t level)
+{
+	tdisplay_brightness(level + 1);
+}
+
+// B1 누름은 야간 플랜 전환 요청. 디바운스는 button 모듈이 한다
+static void poll_buttons(void)
+{
+	button_event_t ev;
 
-		case MODE_NIGHT:
-			night_fsm_run(now);
-			break;
+	while (button_get(&ev))
+	{
+		if (ev.id == b1_id && ev.type == BUTTON_PRESS)
+		{
+			night_request = true;
+			tlog_write(TLOG_EV_BUTTON, 1);
 		}
 	}
 }
 
-void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+void traffic_light_run(void)
 {
-	static uint32_t last_exti_ms = 0;
-	uint32_t now = get_tim2_ms();
+	uint32_t now;
+
+	tlog_init();
+	treplay_init();
+	schedule_init();
+	tdisplay_init();
+	bam_init(LED_PORT, GREEN_LED_PIN | YELLOW_LED_PIN | RED_LED_PIN);
+	ambient_init(on_ambient);
+	button_init();
+	b1_id = button_add(B1_GPIO_Port, B1_Pin, true);
+	console_register("rec", traffic_cmd_rec);
+	console_register("replay", traffic_cmd_replay);
+	console_register("explore", traffic_cmd_explore);
+
+	fsm_tick = get_tim2_ms();
+	traffic_fsm_init(&fsm, fsm_tick);
+	apply_outputs(&fsm.out, true);
+	tlog_write(TLOG_EV_PHASE, DAY_GREEN);
 
-	if (GPIO_Pin == B1_Pin)
+	while (1)
 	{
-		if (now - last_exti_ms > 200) // 디바운스
+		now = get_tim2_ms();
+
+		console_poll();
+		poll_buttons();
+
+		// 1ms 틱을 빠짐없이 처리해야 재생 결과와 일치한다
+		while (fsm_tick != now)
 		{
-			night_request = true;
-			last_exti_ms = now;
+			uint8_t inputs = schedule_take_input();
+
+			if (night_request)
+			{
+				night_request = false;
+				inputs |= TL_IN_BUTTON;
+			}
+
+			fsm_tick++;
+			traffic_step(fsm_tick, inputs);
 		}
+
+		apply_outputs(&fsm.out, false);
+		tdisplay_poll();
 	}
 }
@@ -0,0 +1,110 @@
+// 신호등 상태 전이 이벤트 로그 (RAM 링버퍼)
+
+#include "main.h"
+#include "00_timer2.h"
+#include "07_traffic_log.h"
+#include "dwt.h"
+#include "uart_console.h"
+
+#define TLOG_MASK (TLOG_CAPACITY - 1)
+#define TLOG_BENCH_LOOPS 64
+
+_Static_assert((TLOG_CAPACITY & TLOG_MASK) == 0, "TLOG_CAPACITY must be a power of 2");
+_Static_assert(sizeof(tlog_record_t) == 8, "tlog_record_t must stay 8 bytes");
+
+static tlog_record_t tlog_buf[TLOG_CAPACITY];
+// 지금까지 예약된 레코드 수. 슬롯 위치는 하위 비트로 구한다.
+static volatile uint32_t tlog_head = 0;
+
+static void tlog_cmd_dump(const char *args);
+static void tlog_cmd_bench(const char *args);
+
+void tlog_init(void)
+{
+	tlog_head = 0;
+	dwt_init();
+	console_register("dump", tlog_cmd_dump);
+	console_register("tlogbench", tlog_cmd_bench);
+}
+
+// LDREX/STREX로 슬롯을 예약하므로 메인 루프와 ISR 어디서든 호출 가능
+void tlog_write(uint8_t event, uint16_t payload)
+{
+	uint32_t seq;
+
+	do {
+		seq = __LDREXW(&tlog_head);
+	} while (__STREXW(seq + 1, &tlog_head));
+
+	tlog_record_t *rec = &tlog_buf[seq & TLOG_MASK];
+	rec->tick_ms = get_tim2_ms();
+	rec->event = event;
+	rec->seq = (uint8_t)seq;
+	rec->payload = payload;
+}
+
+// 헤더("TLOG", 레코드 수, 레코드 크기) 뒤에 오래된 순으로 한 번에 전송
+void tlog_dump(void)
+{
+	uint32_t head = tlog_head;
+	uint32_t count = (head < TLOG_CAPACITY) ? head : TLOG_CAPACITY;
+	uint32_t first = (head - count) & TLOG_MASK;
+	uint8_t header[8] = { 'T', 'L', 'O', 'G',
+	                      (uint8_t)count, (uint8_t)(count >> 8),
+	                      sizeof(tlog_record_t), 0 };
+
+	console_write(header, sizeof(header));
+
+	if (first + count > TLOG_CAPACITY)
+	{
+		console_write(&tlog_buf[first], (TLOG_CAPACITY - first) * sizeof(tlog_record_t));
+		console_write(&tlog_buf[0], (first + count - TLOG_CAPACITY) * sizeof(tlog_record_t));
+	}
+	else
+	{
+		console_write(&tlog_buf[first], count * sizeof(tlog_record_t));
+	}
+}
+
+// 이벤트 1건 기록에 걸리는 평균 사이클. 측정 후 버퍼는 원래대로 되돌린다.
+uint32_t tlog_bench_cycles(void)
+{
+	static tlog_record_t saved[TLOG_BENCH_LOOPS];
+	uint32_t primask = __get_PRIMASK();
+	uint32_t head, start, cycles;
+
+	// 측정 중 ISR 기록이 섞이지 않도록 막는다
+	__disable_irq();
+	head = tlog_head;
+
+	for (uint32_t i = 0; i < TLOG_BENCH_LOOPS; ++i) {
+		saved[i] = tlog_buf[(head + i) & TLOG_MASK];
+	}
+
+	start = dwt_cycles();
+	for (uint32_t i = 0; i < TLOG_BENCH_LOOPS; ++i) {
+		tlog_write(0, (uint16_t)i);
+	}
+	cycles = dwt_cycles() - start;
+
+	for (uint32_t i = 0; i < TLOG_BENCH_LOOPS; ++i) {
+		tlog_buf[(head + i) & TLOG_MASK] = saved[i];
+	}
+	tlog_head = head;
+	__set_PRIMASK(primask);
+
+	return cycles / TLOG_BENCH_LOOPS;
+}
+
+static void tlog_cmd_dump(const char *args)
+{
+	tlog_dump();
+}
+
+static void tlog_cmd_bench(const char *args)
+{
+	uint32_t cycles = tlog_bench_cycles();
+
+	console_printf("tlog: %lu cycles/event (%lu ns)\r\n",
+	               (unsigned long)cycles, (unsigned long)dwt_cycles_to_ns(cycles));
+}
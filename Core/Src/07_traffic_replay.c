@@ -0,0 +1,196 @@
+// 신호등 FSM 입력 기록/재생
+
+#include "main.h"
+#include "00_timer2.h"
+#include "07_traffic_replay.h"
+#include "uart_console.h"
+
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME  16777619UL
+
+#define SIMBENCH_SPACING_MS 60000UL
+
+static trec_input_t rec_inputs[TREC_CAPACITY];
+static size_t rec_count = 0;
+static bool rec_overflow = false;
+static bool recording = false;
+static uint32_t rec_start = 0;
+static uint32_t rec_end = 0;
+static trace_sum_t rec_trace;
+
+static void treplay_cmd_dump(const char *args);
+static void treplay_cmd_simbench(const char *args);
+
+void trace_sum_init(trace_sum_t *sum)
+{
+	sum->changes = 0;
+	sum->hash = FNV_OFFSET;
+}
+
+static uint32_t fnv_byte(uint32_t hash, uint8_t b)
+{
+	return (hash ^ b) * FNV_PRIME;
+}
+
+void trace_sum_add(trace_sum_t *sum, uint32_t tick, const traffic_out_t *out)
+{
+	uint32_t h = sum->hash;
+
+	for (int i = 0; i < 32; i += 8) {
+		h = fnv_byte(h, (uint8_t)(tick >> i));
+	}
+	h = fnv_byte(h, out->lamps);
+	h = fnv_byte(h, out->display);
+	h = fnv_byte(h, (uint8_t)out->countdown_ds);
+	h = fnv_byte(h, (uint8_t)(out->countdown_ds >> 8));
+
+	sum->hash = h;
+	sum->changes++;
+}
+
+void trec_begin(uint32_t start_tick)
+{
+	rec_count = 0;
+	rec_overflow = false;
+	rec_start = start_tick;
+	rec_end = start_tick;
+	trace_sum_init(&rec_trace);
+	recording = true;
+}
+
+void trec_input(uint32_t tick, uint8_t inputs)
+{
+	if (!recording) {
+		return;
+	}
+
+	if (rec_count < TREC_CAPACITY) {
+		rec_inputs[rec_count].tick = tick - rec_start;
+		rec_inputs[rec_count].inputs = inputs;
+		rec_count++;
+	}
+	else {
+		rec_overflow = true;
+	}
+}
+
+// 기록 시작 기준 상대 틱으로 해시해야 다른 시각에 재생해도 비교할 수 있다
+void trec_output(uint32_t tick, const traffic_out_t *out)
+{
+	if (recording) {
+		trace_sum_add(&rec_trace, tick - rec_start, out);
+	}
+}
+
+void trec_end(uint32_t end_tick)
+{
+	if (recording) {
+		rec_end = end_tick - rec_start;
+		recording = false;
+	}
+}
+
+bool trec_active(void)
+{
+	return recording;
+}
+
+// 입력 틱은 start_tick 기준 상대값, 오름차순.
+// 출력이 바뀔 수 있는 데드라인과 입력 틱에서만 FSM을 진행시켜 실시간보다 빠르게 돌린다.
+void treplay_run(const trec_input_t *inputs, size_t count,
+                 uint32_t start_tick, uint32_t end_tick, trace_sum_t *sum)
+{
+	traffic_fsm_t fsm;
+	traffic_out_t prev;
+	uint32_t now = start_tick;
+	size_t next = 0;
+
+	traffic_fsm_init(&fsm, start_tick);
+	prev = fsm.out;
+
+	while ((int32_t)(end_tick - now) > 0)
+	{
+		uint32_t deadline = traffic_fsm_next_deadline(&fsm, now);
+		uint8_t in = 0;
+
+		if (next < count && (int32_t)(start_tick + inputs[next].tick - deadline) <= 0)
+		{
+			deadline = start_tick + inputs[next].tick;
+			in = inputs[next++].inputs;
+		}
+		if ((int32_t)(deadline - end_tick) > 0)
+		{
+			break;
+		}
+
+		now = deadline;
+		traffic_fsm_step(&fsm, now, in);
+
+		if (!traffic_out_equal(&fsm.out, &prev))
+		{
+			trace_sum_add(sum, now - start_tick, &fsm.out);
+			prev = fsm.out;
+		}
+	}
+}
+
+void treplay_init(void)
+{
+	console_register("recdump", treplay_cmd_dump);
+	console_register("simbench", treplay_cmd_simbench);
+}
+
+// 기록된 입력을 재생해 실제 출력 트레이스와 비교
+void treplay_report(void)
+{
+	trace_sum_t sum;
+
+	trace_sum_init(&sum);
+	treplay_run(rec_inputs, rec_count, 0, rec_end, &sum);
+
+	console_printf("replay: %lu ms, %u inputs%s, live %lu/%08lx, replay %lu/%08lx -> %s\r\n",
+	               (unsigned long)rec_end, (unsigned)rec_count, rec_overflow ? " (overflow)" : "",
+	               (unsigned long)rec_trace.changes, (unsigned long)rec_trace.hash,
+	               (unsigned long)sum.changes, (unsigned long)sum.hash,
+	               (sum.hash == rec_trace.hash && sum.changes == rec_trace.changes) ? "MATCH" : "DIFF");
+}
+
+// 헤더("TREC", 입력 수, 기록 길이 ms) 뒤에 trec_input_t 배열
+static void treplay_cmd_dump(const char *args)
+{
+	uint8_t header[10] = { 'T', 'R', 'E', 'C',
+	                       (uint8_t)rec_count, (uint8_t)(rec_count >> 8),
+	                       (uint8_t)rec_end, (uint8_t)(rec_end >> 8),
+	                       (uint8_t)(rec_end >> 16), (uint8_t)(rec_end >> 24) };
+
+	console_write(header, sizeof(header));
+	console_write(rec_inputs, rec_count * sizeof(rec_inputs[0]));
+}
+
+// 1분 간격 버튼 입력으로 약 4시간을 모의 실행해 처리량을 잰다
+static void treplay_cmd_simbench(const char *args)
+{
+	static trec_input_t sim_inputs[TREC_CAPACITY];
+	uint32_t span_ms = (TREC_CAPACITY + 1) * SIMBENCH_SPACING_MS;
+	uint32_t start, wall_ms;
+	trace_sum_t sum;
+
+	for (uint32_t i = 0; i < TREC_CAPACITY; ++i) {
+		sim_inputs[i].tick = (i + 1) * SIMBENCH_SPACING_MS - 1;
+		sim_inputs[i].inputs = TL_IN_BUTTON;
+	}
+
+	trace_sum_init(&sum);
+	start = get_tim2_ms();
+	treplay_run(sim_inputs, TREC_CAPACITY, 0, span_ms, &sum);
+	wall_ms = get_tim2_ms() - start;
+	if (wall_ms == 0) {
+		wall_ms = 1;
+	}
+
+	// 모의 시간(h) / 실제 시간(s), 소수점 3자리 고정소수점
+	console_printf("simbench: %lu sim ms in %lu ms, %lu changes, %lu.%03lu sim h/s\r\n",
+	               (unsigned long)span_ms, (unsigned long)wall_ms, (unsigned long)sum.changes,
+	               (unsigned long)(span_ms / 3600UL / wall_ms),
+	               (unsigned long)(((uint64_t)span_ms * 1000ULL / 3600UL / wall_ms) % 1000ULL));
+}
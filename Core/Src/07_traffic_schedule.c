@@ -0,0 +1,92 @@
+// RTC 시각 기반 주간/야간 플랜 스케줄
+//
+// 시계는 schedule_clock_t로만 만지므로 HAL 없이 컴파일된다. 타깃의 RTC 연결과 콘솔 명령은
+// 07_traffic_schedule_rtc.c에 있고, 자정/월말 넘김은 host/schedule_test.c가 가짜 시계로 검사한다.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "07_traffic_schedule.h"
+
+// 시각 오름차순. 마지막 항목은 자정을 넘어 첫 항목 전까지 유지된다.
+static const schedule_entry_t schedule[] = {
+	{  6 * 60, PLAN_DAY },
+	{ 22 * 60, PLAN_NIGHT },
+};
+
+#define SCHEDULE_COUNT (sizeof(schedule) / sizeof(schedule[0]))
+
+static const schedule_clock_t *sched_clock = NULL;
+static volatile bool alarm_fired = false;
+static volatile uint8_t pending_input = 0;
+
+traffic_plan_t schedule_plan_at(uint16_t minute_of_day)
+{
+	traffic_plan_t plan = schedule[SCHEDULE_COUNT - 1].plan;
+
+	for (size_t i = 0; i < SCHEDULE_COUNT; ++i)
+	{
+		if (schedule[i].minute > minute_of_day) {
+			break;
+		}
+		plan = schedule[i].plan;
+	}
+	return plan;
+}
+
+// minute_of_day 이후 첫 경계. 오늘 남은 경계가 없으면 내일 첫 경계
+uint16_t schedule_next_boundary(uint16_t minute_of_day)
+{
+	for (size_t i = 0; i < SCHEDULE_COUNT; ++i)
+	{
+		if (schedule[i].minute > minute_of_day) {
+			return schedule[i].minute;
+		}
+	}
+	return schedule[0].minute;
+}
+
+static uint16_t current_minute(void)
+{
+	rtc_time_t t;
+
+	sched_clock->get(&t);
+	return (uint16_t)(t.hour * 60 + t.minute);
+}
+
+static void schedule_alarm_cb(void)
+{
+	alarm_fired = true;
+}
+
+// 현재 시각의 플랜을 FSM 입력으로 올리고 다음 경계에 알람을 건다
+void schedule_resync(void)
+{
+	uint16_t minute = current_minute();
+	uint16_t next = schedule_next_boundary(minute);
+
+	pending_input = (schedule_plan_at(minute) == PLAN_NIGHT) ? TL_IN_PLAN_NIGHT : TL_IN_PLAN_DAY;
+	sched_clock->set_alarm(next / 60, next % 60, schedule_alarm_cb);
+}
+
+void schedule_start(const schedule_clock_t *clock)
+{
+	sched_clock = clock;
+	alarm_fired = false;
+	schedule_resync();
+}
+
+// 메인 루프에서 호출. 알람이 울렸을 때만 시계를 읽는다.
+uint8_t schedule_take_input(void)
+{
+	uint8_t input;
+
+	if (alarm_fired)
+	{
+		alarm_fired = false;
+		schedule_resync();
+	}
+
+	input = pending_input;
+	pending_input = 0;
+	return input;
+}
@@ -0,0 +1,67 @@
+// 스케줄을 F411 RTC에 연결하고 시각 설정/조회 콘솔 명령을 단다
+
+#include <stdio.h>
+#include "main.h"
+#include "07_traffic_schedule.h"
+#include "rtc_clock.h"
+#include "uart_console.h"
+
+static const schedule_clock_t rtc_schedule_clock = {
+	.get = rtc_clock_get,
+	.set_alarm = rtc_clock_set_alarm,
+};
+
+static void schedule_cmd_time(const char *args);
+static void schedule_cmd_sched(const char *args);
+
+void schedule_init(void)
+{
+	rtc_clock_init();
+	schedule_start(&rtc_schedule_clock);
+
+	console_register("time", schedule_cmd_time);
+	console_register("sched", schedule_cmd_sched);
+}
+
+// "time" 현재 시각 출력, "time YYYY-MM-DD HH:MM:SS" 시각 설정
+static void schedule_cmd_time(const char *args)
+{
+	unsigned year, month, day, hour, minute, second;
+	rtc_time_t t;
+
+	if (sscanf(args, "%u-%u-%u %u:%u:%u", &year, &month, &day, &hour, &minute, &second) == 6)
+	{
+		t.year = (uint8_t)(year % 100);
+		t.month = (uint8_t)month;
+		t.day = (uint8_t)day;
+		t.hour = (uint8_t)hour;
+		t.minute = (uint8_t)minute;
+		t.second = (uint8_t)second;
+
+		if (year < 2000 || year > 2099 || !rtc_clock_set(&t))
+		{
+			console_printf("time: invalid\r\n");
+			return;
+		}
+		schedule_resync();
+	}
+
+	rtc_clock_get(&t);
+	console_printf("time: 20%02u-%02u-%02u %02u:%02u:%02u\r\n",
+	               t.year, t.month, t.day, t.hour, t.minute, t.second);
+}
+
+static void schedule_cmd_sched(const char *args)
+{
+	rtc_time_t t;
+	uint16_t minute, next;
+
+	rtc_clock_get(&t);
+	minute = (uint16_t)(t.hour * 60 + t.minute);
+	next = schedule_next_boundary(minute);
+
+	console_printf("sched: %s, next %02u:%02u -> %s\r\n",
+	               (schedule_plan_at(minute) == PLAN_NIGHT) ? "night" : "day",
+	               next / 60, next % 60,
+	               (schedule_plan_at(next) == PLAN_NIGHT) ? "night" : "day");
+}
@@ -0,0 +1,237 @@
+// 시그마-델타 디더링으로 1000단계 PWM에서 16비트 평균 듀티 만들기
+//
+// 16비트 목표 듀티를 주기마다 누적해 넘친 만큼만 CCR을 1 올린다(1차 오차 누적).
+// 한 패스(PWM_DITHER_LEN 주기) 패턴은 미리 계산해 두고 08_pwm_wave의 DMA 엔진이
+// 흘려보내므로 주기마다 CPU가 할 일은 없다.
+
+#include <math.h>
+#include <stdio.h>
+#include "main.h"
+#include "08_pwm_dither.h"
+#include "08_pwm_wave.h"
+#include "pwm_lut.h"
+#include "uart_console.h"
+
+// 16비트 누적기 1바퀴
+#define DITHER_ONE 65536U
+
+// 패턴 한 패스. 누적기를 반에서 시작하면 평균이 반올림된다.
+void pwm_dither_build(uint32_t *table, uint16_t len, uint16_t duty16)
+{
+	uint32_t acc = DITHER_ONE / 2;
+
+	for (uint16_t i = 0; i < len; ++i)
+	{
+		acc += (uint32_t)duty16 * PWM_LUT_FULL;
+		table[i] = acc >> 16;
+		acc &= DITHER_ONE - 1;
+	}
+}
+
+// 평균 듀티 오차, 리플 크기, DFT로 본 리플 스펙트럼 (진폭 큰 빈부터)
+void pwm_dither_analyze(const uint32_t *table, uint16_t len, uint16_t duty16, pwm_dither_report_t *report)
+{
+	uint32_t sum = 0;
+	uint16_t lo = UINT16_MAX, hi = 0;
+
+	for (uint16_t i = 0; i < len; ++i)
+	{
+		sum += table[i];
+		if (table[i] < lo) {
+			lo = (uint16_t)table[i];
+		}
+		if (table[i] > hi) {
+			hi = (uint16_t)table[i];
+		}
+	}
+
+	report->sum = sum;
+	report->ccr_min = lo;
+	report->ccr_max = hi;
+	report->error_ppm = (int32_t)(((int64_t)sum * DITHER_ONE - (int64_t)duty16 * PWM_LUT_FULL * len) * 1000000
+	                              / ((int64_t)len * PWM_LUT_FULL * DITHER_ONE));
+	report->bin_count = 0;
+
+	float mean = (float)sum / len;
+
+	for (uint16_t k = 1; k <= len / 2; ++k)
+	{
+		float re = 0.0f, im = 0.0f;
+
+		for (uint16_t n = 0; n < len; ++n)
+		{
+			float w = 2.0f * (float)M_PI * k * n / len;
+			re += (table[n] - mean) * cosf(w);
+			im -= (table[n] - mean) * sinf(w);
+		}
+
+		// 나이퀴스트 빈은 짝이 없어서 2를 곱하지 않는다
+		float amp = sqrtf(re * re + im * im) * ((k == len / 2) ? 1.0f : 2.0f) / len;
+		pwm_dither_bin_t bin = { k, (uint32_t)(amp * 1000.0f + 0.5f) };
+
+		if (bin.amp_mcnt == 0) {
+			continue;
+		}
+
+		// 상위 PWM_DITHER_MAX_BINS개만 삽입 정렬로 유지
+		uint8_t pos = report->bin_count;
+		if (pos == PWM_DITHER_MAX_BINS)
+		{
+			if (bin.amp_mcnt <= report->bins[pos - 1].amp_mcnt) {
+				continue;
+			}
+			pos--;
+		}
+		else
+		{
+			report->bin_count++;
+		}
+		while (pos > 0 && report->bins[pos - 1].amp_mcnt < bin.amp_mcnt)
+		{
+			report->bins[pos] = report->bins[pos - 1];
+			pos--;
+		}
+		report->bins[pos] = bin;
+	}
+}
+
+// 16비트 입력 전체를 훑어 서로 다른 평균 듀티가 몇 개 나오는지 센다 (유효 분해능)
+uint32_t pwm_dither_levels(uint16_t len, int *monotonic)
+{
+	uint32_t levels = 0;
+	uint32_t prev = 0;
+
+	*monotonic = 1;
+	for (uint32_t duty = 0; duty < DITHER_ONE; ++duty)
+	{
+		uint32_t acc = DITHER_ONE / 2;
+		uint32_t sum = 0;
+
+		for (uint16_t i = 0; i < len; ++i)
+		{
+			acc += duty * PWM_LUT_FULL;
+			sum += acc >> 16;
+			acc &= DITHER_ONE - 1;
+		}
+
+		if (duty == 0 || sum != prev) {
+			levels++;
+		}
+		if (duty > 0 && sum < prev) {
+			*monotonic = 0;
+		}
+		prev = sum;
+	}
+
+	return levels;
+}
+
+static uint32_t dither_buf[2][PWM_DITHER_LEN];
+static uint8_t dither_front = 0;
+static uint32_t dither_swaps = 0;
+static int32_t dither_loaded = -1;
+static volatile int32_t dither_hold = -1;   // "dither"로 고정한 듀티, -1이면 램프
+
+// 스트리밍 중이 아닌 버퍼에 새 패턴을 만들고 패스 경계에서 바꾼다.
+// 앞선 교체가 끝나기 전엔 그 버퍼를 DMA가 곧 읽을 수 있으니 건드리지 않는다.
+static int dither_load(uint16_t duty16)
+{
+	pwm_wave_status_t st;
+	uint8_t next = dither_front ^ 1;
+
+	pwm_wave_get_status(&st);
+	if (duty16 == dither_loaded || (st.length != 0 && st.swaps == dither_swaps))
+	{
+		return 0;
+	}
+
+	pwm_dither_build(dither_buf[next], PWM_DITHER_LEN, duty16);
+	pwm_wave_load(dither_buf[next], PWM_DITHER_LEN, 1);
+
+	// 멈춰 있었다면 교체 없이 바로 시작하므로 swaps가 늘지 않는다
+	dither_swaps = (st.length != 0) ? st.swaps + 1 : st.swaps;
+	dither_front = next;
+	dither_loaded = duty16;
+	return 1;
+}
+
+static void dither_print(uint16_t duty16)
+{
+	uint32_t table[PWM_DITHER_LEN];
+	pwm_dither_report_t r;
+
+	pwm_dither_build(table, PWM_DITHER_LEN, duty16);
+	pwm_dither_analyze(table, PWM_DITHER_LEN, duty16, &r);
+
+	uint32_t mean_m = r.sum * 1000 / PWM_DITHER_LEN;
+	console_printf("dither %u: mean %lu.%03lu ccr, error %ld ppm, ripple %u..%u\r\n",
+	               duty16, (unsigned long)(mean_m / 1000), (unsigned long)(mean_m % 1000),
+	               (long)r.error_ppm, r.ccr_min, r.ccr_max);
+
+	for (uint8_t i = 0; i < r.bin_count; ++i)
+	{
+		uint32_t mhz = (uint32_t)r.bins[i].bin * 1000000 / PWM_DITHER_LEN;
+		console_printf("  %4lu.%03lu Hz  %lu mcnt\r\n",
+		               (unsigned long)(mhz / 1000), (unsigned long)(mhz % 1000),
+		               (unsigned long)r.bins[i].amp_mcnt);
+	}
+}
+
+// "dither D" 16비트 듀티로 고정하고 분석 결과 출력. "dither" 만 치면 램프로 돌아간다
+static void dither_cmd(const char *args)
+{
+	unsigned duty;
+
+	if (sscanf(args, "%u", &duty) != 1)
+	{
+		dither_hold = -1;
+		return;
+	}
+	if (duty >= DITHER_ONE)
+	{
+		console_printf("dither: invalid\r\n");
+		return;
+	}
+
+	dither_hold = (int32_t)duty;
+	dither_print((uint16_t)duty);
+}
+
+static void dither_cmd_scan(const char *args)
+{
+	int monotonic;
+	uint32_t levels = pwm_dither_levels(PWM_DITHER_LEN, &monotonic);
+
+	console_printf("ditherscan: %lu levels (%lu.%02lu bits), %s\r\n",
+	               (unsigned long)levels,
+	               (unsigned long)log2f((float)levels),
+	               (unsigned long)(log2f((float)levels) * 100.0f) % 100,
+	               monotonic ? "monotonic" : "NOT monotonic");
+}
+
+// 가장 어두운 구간(0 ~ 1/16)을 천천히 오르내린다. 10비트 PWM으로는 64단계뿐인 구간
+void pwm_dither_run(void)
+{
+	int32_t duty = 0;
+	int32_t step = 16;
+
+	pwm_wave_init();
+	console_register("dither", dither_cmd);
+	console_register("ditherscan", dither_cmd_scan);
+
+	while (1)
+	{
+		console_poll();
+
+		uint16_t target = (dither_hold >= 0) ? (uint16_t)dither_hold : (uint16_t)duty;
+
+		if (dither_load(target) && dither_hold < 0)
+		{
+			duty += step;
+			if (duty >= (int32_t)(DITHER_ONE / 16) || duty <= 0) {
+				step = -step;
+			}
+		}
+		__WFI();
+	}
+}
@@ -0,0 +1,273 @@
+// DMA로 듀티 테이블을 TIM2 CCR1에 흘려보내는 PWM 파형 엔진
+//
+// TIM2 업데이트 이벤트(1ms)마다 DMA1 Stream1(채널 3, TIM2_UP)이 테이블 한 칸을
+// CCR1에 쓴다. CCR1 프리로드가 켜져 있어 값은 다음 주기부터 반영된다.
+// 순환 모드로 계속 돌고, 테이블 교체는 패스가 끝나는 TC 인터럽트에서만 한다.
+// TC는 패스마다(1ms 업데이트라 초당 수십 번 이하) 켜 두고 끝난 패스의 전송 수를 쌓아서,
+// 전송 수는 시간이 아니라 DMA가 실제로 옮긴 칸(끝난 패스 + 지금 패스의 len - NDTR)으로 낸다.
+
+#include <stdio.h>
+#include "main.h"
+#include "08_pwm_wave.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include "pwm_lut.h"
+#include "uart_console.h"
+
+#define DMA1_S1_FLAGS (DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 \
+                       | DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1)
+
+extern TIM_HandleTypeDef htim2;
+DMA_HandleTypeDef hdma_tim2_up;
+
+static uint32_t wave_buf[2][PWM_WAVE_MAX_SAMPLES];
+
+static const uint32_t *front = NULL;      // DMA가 읽고 있는 테이블
+static uint16_t front_len = 0;
+static const uint32_t *volatile back = NULL;
+static volatile uint16_t back_len = 0;
+static volatile bool swap_pending = false;
+
+static volatile uint32_t swaps = 0;
+static volatile uint32_t passes = 0;      // 끝난 패스 수
+static volatile uint32_t done = 0;        // 끝난 패스들의 전송 수
+
+void pwm_wave_init(void)
+{
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	hdma_tim2_up.Instance = DMA1_Stream1;
+	hdma_tim2_up.Init.Channel = DMA_CHANNEL_3;
+	hdma_tim2_up.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma_tim2_up.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_tim2_up.Init.MemInc = DMA_MINC_ENABLE;
+	// TIM2 CCR은 32비트라 하프워드로 쓰면 상위에 값이 복제된다
+	hdma_tim2_up.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	hdma_tim2_up.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	hdma_tim2_up.Init.Mode = DMA_CIRCULAR;
+	hdma_tim2_up.Init.Priority = DMA_PRIORITY_HIGH;
+	hdma_tim2_up.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(&hdma_tim2_up) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, IRQ_PRIO_STREAM, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+}
+
+// divider가 1이면 테이블(RAM/플래시)을 그대로 쓰고,
+// 아니면 스트리밍 중이 아닌 RAM 버퍼에 샘플마다 divider번 반복해 펼친다
+static const uint32_t *prepare(const uint32_t *table, uint16_t len, uint16_t divider, uint16_t *out_len)
+{
+	if (divider <= 1)
+	{
+		*out_len = len;
+		return table;
+	}
+
+	if ((uint32_t)len * divider > PWM_WAVE_MAX_SAMPLES)
+	{
+		return NULL;
+	}
+
+	uint32_t *buf = (front == wave_buf[0]) ? wave_buf[1] : wave_buf[0];
+	uint32_t *p = buf;
+
+	for (uint16_t i = 0; i < len; ++i) {
+		for (uint16_t k = 0; k < divider; ++k) {
+			*p++ = table[i];
+		}
+	}
+
+	*out_len = (uint16_t)(len * divider);
+	return buf;
+}
+
+// 멈춰 있으면 바로 시작하고, 돌고 있으면 현재 패스가 끝날 때 교체한다
+bool pwm_wave_load(const uint32_t *table, uint16_t len, uint16_t divider)
+{
+	const uint32_t *next;
+	uint16_t next_len;
+
+	if (table == NULL || len == 0)
+	{
+		return false;
+	}
+
+	// 대기 중인 교체를 먼저 취소해야 준비 중인 버퍼로 넘어가지 않는다
+	hdma_tim2_up.Instance->CR &= ~DMA_SxCR_TCIE;
+	swap_pending = false;
+
+	next = prepare(table, len, divider, &next_len);
+	if (next == NULL)
+	{
+		// 패스 세기는 계속한다 (그사이 끝난 패스는 TCIF가 남아 있어 바로 들어온다)
+		if (front != NULL) {
+			hdma_tim2_up.Instance->CR |= DMA_SxCR_TCIE;
+		}
+		return false;
+	}
+
+	if (front == NULL)
+	{
+		front = next;
+		front_len = next_len;
+		passes = 0;
+		done = 0;
+
+		HAL_DMA_Start(&hdma_tim2_up, (uint32_t)next, (uint32_t)&htim2.Instance->CCR1, next_len);
+		hdma_tim2_up.Instance->CR |= DMA_SxCR_TCIE;
+		__HAL_TIM_ENABLE_DMA(&htim2, TIM_DMA_UPDATE);
+		HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
+		return true;
+	}
+
+	back = next;
+	back_len = next_len;
+	swap_pending = true;
+	hdma_tim2_up.Instance->CR |= DMA_SxCR_TCIE;
+	return true;
+}
+
+void pwm_wave_stop(void)
+{
+	hdma_tim2_up.Instance->CR &= ~DMA_SxCR_TCIE;
+	swap_pending = false;
+
+	__HAL_TIM_DISABLE_DMA(&htim2, TIM_DMA_UPDATE);
+	HAL_DMA_Abort(&hdma_tim2_up);
+	front = NULL;
+}
+
+// DMA1_Stream1_IRQHandler에서 호출. 스트리밍 중에는 패스마다 TC가 들어온다.
+void pwm_wave_dma_irq(void)
+{
+	DMA_Stream_TypeDef *stream = hdma_tim2_up.Instance;
+
+	if (!(DMA1->LISR & DMA_LISR_TCIF1))
+	{
+		DMA1->LIFCR = DMA1_S1_FLAGS;
+		return;
+	}
+
+	DMA1->LIFCR = DMA1_S1_FLAGS;
+	passes++;
+	done += front_len;
+
+	if (swap_pending)
+	{
+		// 다음 DMA 요청은 1ms 뒤에 오므로 그 전에 다시 켜면 샘플이 빠지지 않는다
+		stream->CR &= ~DMA_SxCR_EN;
+		while (stream->CR & DMA_SxCR_EN) {}
+		DMA1->LIFCR = DMA1_S1_FLAGS;
+
+		stream->M0AR = (uint32_t)back;
+		stream->NDTR = back_len;
+		stream->CR |= DMA_SxCR_EN;
+
+		front = back;
+		front_len = back_len;
+		swap_pending = false;
+		swaps++;
+	}
+}
+
+void pwm_wave_get_status(pwm_wave_status_t *status)
+{
+	DMA_Stream_TypeDef *stream = hdma_tim2_up.Instance;
+	uint32_t cs = cs_enter(CS_WAVE_COUNT);
+	uint32_t ndtr = stream->NDTR;
+	uint32_t n = passes, sum = done;
+
+	// 패스가 막 끝났는데 TC 인터럽트가 아직 안 불렸으면 NDTR은 이미 새 패스다
+	if (DMA1->LISR & DMA_LISR_TCIF1)
+	{
+		ndtr = stream->NDTR;
+		n++;
+		sum += front_len;
+	}
+
+	status->cr = stream->CR;
+	status->ndtr = ndtr;
+	status->par = stream->PAR;
+	status->m0ar = stream->M0AR;
+	status->length = front_len;
+	status->passes = (front != NULL) ? n : 0;
+	status->transfers = (front != NULL) ? sum + (front_len - ndtr) : 0;
+	status->swaps = swaps;
+	cs_exit(cs);
+}
+
+#define BREATH_STEPS 64
+
+static uint32_t breath[BREATH_STEPS];
+static uint64_t awake_cycles = 0;
+static uint64_t total_cycles = 0;
+
+static void pwm_wave_cmd_status(const char *args)
+{
+	pwm_wave_status_t st;
+
+	pwm_wave_get_status(&st);
+	console_printf("wave: CR=%08lx NDTR=%lu PAR=%08lx M0AR=%08lx len=%lu\r\n",
+	               (unsigned long)st.cr, (unsigned long)st.ndtr, (unsigned long)st.par,
+	               (unsigned long)st.m0ar, (unsigned long)st.length);
+	console_printf("wave: %lu transfers in %lu passes, %lu swaps, cpu awake %lu.%02lu%%\r\n",
+	               (unsigned long)st.transfers, (unsigned long)st.passes, (unsigned long)st.swaps,
+	               (unsigned long)(awake_cycles * 100 / (total_cycles ? total_cycles : 1)),
+	               (unsigned long)(awake_cycles * 10000 / (total_cycles ? total_cycles : 1) % 100));
+}
+
+// "wavediv N" 같은 숨쉬기 테이블을 N ms 간격으로 다시 로드 (패스 경계에서 교체)
+static void pwm_wave_cmd_div(const char *args)
+{
+	unsigned divider = 0;
+
+	if (sscanf(args, "%u", &divider) != 1 || !pwm_wave_load(breath, BREATH_STEPS, (uint16_t)divider))
+	{
+		console_printf("wavediv: invalid\r\n");
+	}
+}
+
+static void pwm_wave_cmd_lutbench(const char *args)
+{
+	uint32_t lut_cycles, powf_cycles;
+
+	pwm_lut_bench(&lut_cycles, &powf_cycles);
+	console_printf("lut: %lu cycles/level, powf: %lu cycles/level\r\n",
+	               (unsigned long)(lut_cycles / PWM_LUT_LEVELS),
+	               (unsigned long)(powf_cycles / PWM_LUT_LEVELS));
+}
+
+// 03_led_pwm의 숨쉬기를 DMA로 (감마 보정, 10ms 스텝). CPU는 WFI로 잠든다.
+void pwm_wave_run(void)
+{
+	for (uint32_t i = 0; i < BREATH_STEPS / 2; ++i)
+	{
+		uint8_t level = (uint8_t)(i * (PWM_LUT_LEVELS - 1) / (BREATH_STEPS / 2 - 1));
+
+		breath[i] = pwm_lut_ccr(PWM_CURVE_GAMMA22, level);
+		breath[BREATH_STEPS - 1 - i] = breath[i];
+	}
+
+	dwt_init();
+	pwm_wave_init();
+	pwm_wave_load(breath, BREATH_STEPS, 10);
+
+	console_register("wave", pwm_wave_cmd_status);
+	console_register("wavediv", pwm_wave_cmd_div);
+	console_register("lutbench", pwm_wave_cmd_lutbench);
+
+	while (1)
+	{
+		uint32_t t0 = dwt_cycles();
+		console_poll();
+		uint32_t t1 = dwt_cycles();
+		__WFI();
+		uint32_t t2 = dwt_cycles();
+
+		awake_cycles += t1 - t0;
+		total_cycles += t2 - t0;
+	}
+}
@@ -0,0 +1,401 @@
+// TIM2 CH1~CH4를 RGBW로 쓰는 색상 엔진
+//
+// HSV -> RGB 는 정수 연산만 쓰고, 채널마다 감마 곡선과 스케일(화이트 밸런스)을 따로 둔다.
+// 네 CCR은 DMA 버스트로 한 번에 쓴다. 업데이트 이벤트마다 DMA1 Stream7(채널 3, TIM2_UP)이
+// TIM2->DMAR 로 4워드를 보내고, CCR 프리로드 덕분에 네 값이 다음 업데이트에서 동시에 반영된다.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "00_timer2.h"
+#include "09_color.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include "uart_console.h"
+
+#define DMA1_S7_FLAGS (DMA_HIFCR_CTCIF7 | DMA_HIFCR_CHTIF7 | DMA_HIFCR_CTEIF7 \
+                       | DMA_HIFCR_CDMEIF7 | DMA_HIFCR_CFEIF7)
+
+// 업데이트 직전 이 시간(us, TIM2 카운트) 안에는 스테이징 버퍼를 건드리지 않는다
+#define COLOR_GUARD_US 16
+// 페이드 프레임 간격
+#define COLOR_FRAME_MS 10
+// 페이드 진행률 분해능
+#define FADE_ONE 1024
+
+extern TIM_HandleTypeDef htim2;
+static DMA_HandleTypeDef hdma_tim2_burst;
+
+// DMA가 DMAR로 보내는 CCR1~CCR4
+static uint32_t burst[COLOR_CHANNELS];
+
+static pwm_curve_t gamma_curve[COLOR_CHANNELS] = {
+	PWM_CURVE_GAMMA22, PWM_CURVE_GAMMA22, PWM_CURVE_GAMMA22, PWM_CURVE_GAMMA22
+};
+static uint8_t gamma_scale[COLOR_CHANNELS] = { 255, 255, 255, 255 };
+
+static hsv_t current;
+static hsv_t fade_from;
+static hsv_t fade_to;
+static int16_t fade_dh;
+static uint32_t fade_start;
+static uint32_t fade_duration;
+
+// x / 255 반올림 (x <= 65535)
+static inline uint8_t div255(uint32_t x)
+{
+	x += 128;
+	return (uint8_t)((x + (x >> 8)) >> 8);
+}
+
+static inline uint8_t min3(uint8_t a, uint8_t b, uint8_t c)
+{
+	uint8_t m = (a < b) ? a : b;
+	return (m < c) ? m : c;
+}
+
+static rgbw_t hsv_to_rgb(hsv_t hsv)
+{
+	uint8_t v = hsv.v;
+	uint8_t s = hsv.s;
+	uint8_t f = hsv.h & 0xFF;
+	uint8_t p = div255((uint32_t)v * (255 - s));
+	uint8_t q = div255((uint32_t)v * (255 - div255((uint32_t)s * f)));
+	uint8_t t = div255((uint32_t)v * (255 - div255((uint32_t)s * (255 - f))));
+
+	switch ((hsv.h >> 8) % 6)
+	{
+	case 0:  return (rgbw_t){ v, t, p, 0 };
+	case 1:  return (rgbw_t){ q, v, p, 0 };
+	case 2:  return (rgbw_t){ p, v, t, 0 };
+	case 3:  return (rgbw_t){ p, q, v, 0 };
+	case 4:  return (rgbw_t){ t, p, v, 0 };
+	default: return (rgbw_t){ v, p, q, 0 };
+	}
+}
+
+// 벤치마크 기준값. 구간 나누는 방식은 정수판과 같고 계산만 float
+static rgbw_t hsv_to_rgb_float(hsv_t hsv)
+{
+	float v = hsv.v / 255.0f;
+	float s = hsv.s / 255.0f;
+	float hf = hsv.h / 256.0f;
+	int region = (int)hf;
+	float f = hf - region;
+	float p = v * (1.0f - s);
+	float q = v * (1.0f - s * f);
+	float t = v * (1.0f - s * (1.0f - f));
+	float r, g, b;
+
+	switch (region % 6)
+	{
+	case 0:  r = v; g = t; b = p; break;
+	case 1:  r = q; g = v; b = p; break;
+	case 2:  r = p; g = v; b = t; break;
+	case 3:  r = p; g = q; b = v; break;
+	case 4:  r = t; g = p; b = v; break;
+	default: r = v; g = p; b = q; break;
+	}
+
+	return (rgbw_t){ (uint8_t)(r * 255.0f + 0.5f), (uint8_t)(g * 255.0f + 0.5f),
+	                 (uint8_t)(b * 255.0f + 0.5f), 0 };
+}
+
+// W 채널이 있으면 세 색의 공통 성분을 흰색 LED로 옮긴다
+rgbw_t color_hsv_to_rgbw(hsv_t hsv)
+{
+	rgbw_t c = hsv_to_rgb(hsv);
+
+#if COLOR_USE_W_CHANNEL
+	c.w = min3(c.r, c.g, c.b);
+	c.r -= c.w;
+	c.g -= c.w;
+	c.b -= c.w;
+#endif
+	return c;
+}
+
+// 스테이징 버퍼를 바꾸고 다음 업데이트 이벤트에 보낼 버스트를 건다.
+// 업데이트 직전이거나 버스트가 도는 중이면 그게 지날 때까지 기다린다.
+static void commit(const uint32_t ccr[COLOR_CHANNELS])
+{
+	DMA_Stream_TypeDef *stream = hdma_tim2_burst.Instance;
+	uint32_t primask = __get_PRIMASK();
+
+	// 공유 자원이 아니라 시간 창을 지키는 구역이라 BASEPRI가 아니라 PRIMASK로 전부 막는다
+	while (1)
+	{
+		__disable_irq();
+		bool busy = (stream->CR & DMA_SxCR_EN) && stream->NDTR != COLOR_CHANNELS;
+
+		if (!busy && TIM2->CNT + COLOR_GUARD_US < TIM2->ARR) {
+			break;
+		}
+		__set_PRIMASK(primask);
+	}
+
+	memcpy(burst, ccr, sizeof(burst));
+
+	if (!(stream->CR & DMA_SxCR_EN))
+	{
+		DMA1->HIFCR = DMA1_S7_FLAGS;
+		stream->NDTR = COLOR_CHANNELS;
+		stream->CR |= DMA_SxCR_EN;
+	}
+	__set_PRIMASK(primask);
+}
+
+static void apply(hsv_t hsv)
+{
+	rgbw_t c = color_hsv_to_rgbw(hsv);
+	uint8_t level[COLOR_CHANNELS] = { c.r, c.g, c.b, c.w };
+	uint32_t ccr[COLOR_CHANNELS];
+
+	for (int ch = 0; ch < COLOR_CHANNELS; ++ch) {
+		ccr[ch] = pwm_lut_ccr(gamma_curve[ch], div255((uint32_t)level[ch] * gamma_scale[ch]));
+	}
+
+	current = hsv;
+	commit(ccr);
+}
+
+void color_init(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	TIM_OC_InitTypeDef sConfigOC = {0};
+
+	// CH1(PA15)은 MX_TIM2_Init에서 이미 설정됨
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_GPIOB_CLK_ENABLE();
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Alternate = GPIO_AF1_TIM2;
+	GPIO_InitStruct.Pin = GPIO_PIN_1;
+#if COLOR_USE_W_CHANNEL
+	GPIO_InitStruct.Pin |= GPIO_PIN_3;
+#endif
+	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+	GPIO_InitStruct.Pin = GPIO_PIN_10;
+	HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+	sConfigOC.OCMode = TIM_OCMODE_PWM1;
+	sConfigOC.Pulse = 0;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	HAL_TIM_PWM_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_2);
+	HAL_TIM_PWM_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_3);
+	HAL_TIM_PWM_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_4);
+	__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, 0);
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	hdma_tim2_burst.Instance = DMA1_Stream7;
+	hdma_tim2_burst.Init.Channel = DMA_CHANNEL_3;
+	hdma_tim2_burst.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma_tim2_burst.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_tim2_burst.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_tim2_burst.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	hdma_tim2_burst.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	hdma_tim2_burst.Init.Mode = DMA_NORMAL;
+	hdma_tim2_burst.Init.Priority = DMA_PRIORITY_HIGH;
+	hdma_tim2_burst.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(&hdma_tim2_burst) != HAL_OK)
+	{
+		Error_Handler();
+	}
+	hdma_tim2_burst.Instance->PAR = (uint32_t)&TIM2->DMAR;
+	hdma_tim2_burst.Instance->M0AR = (uint32_t)burst;
+
+	// 업데이트 DMA 요청 1번에 CCR1부터 4워드 버스트
+	TIM2->DCR = TIM_DMABASE_CCR1 | TIM_DMABURSTLENGTH_4TRANSFERS;
+	__HAL_TIM_ENABLE_DMA(&htim2, TIM_DMA_UPDATE);
+
+	HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
+	HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_2);
+	HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_3);
+#if COLOR_USE_W_CHANNEL
+	HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_4);
+#endif
+
+	apply((hsv_t){ 0, 0, 0 });
+}
+
+// 채널별 LED 밝기 차이 보정. 다음 색 갱신부터 반영
+void color_set_gamma(color_channel_t ch, pwm_curve_t curve, uint8_t scale)
+{
+	gamma_curve[ch] = curve;
+	gamma_scale[ch] = scale;
+}
+
+static void color_frame(void)
+{
+	uint32_t elapsed = get_tim2_ms() - fade_start;
+
+	if (elapsed >= fade_duration)
+	{
+		apply(fade_to);
+		return;
+	}
+
+	int32_t k = (int32_t)(elapsed * FADE_ONE / fade_duration);
+	int32_t h = fade_from.h + fade_dh * k / FADE_ONE;
+
+	if (h < 0) {
+		h += COLOR_HUE_MAX;
+	}
+	if (h >= COLOR_HUE_MAX) {
+		h -= COLOR_HUE_MAX;
+	}
+
+	apply((hsv_t){
+		(uint16_t)h,
+		(uint8_t)(fade_from.s + (fade_to.s - fade_from.s) * k / FADE_ONE),
+		(uint8_t)(fade_from.v + (fade_to.v - fade_from.v) * k / FADE_ONE),
+	});
+	tim2_schedule(get_tim2_ms() + COLOR_FRAME_MS, color_frame);
+}
+
+void color_set(hsv_t hsv)
+{
+	tim2_cancel(color_frame);
+	apply(hsv);
+}
+
+// 현재 색에서 target까지 duration_ms 동안. 색상(h)은 짧은 쪽으로 돈다
+void color_fade_to(hsv_t target, uint32_t duration_ms)
+{
+	uint32_t cs;
+	int16_t dh;
+
+	tim2_cancel(color_frame);
+	if (duration_ms == 0)
+	{
+		apply(target);
+		return;
+	}
+
+	cs = cs_enter(CS_COLOR_FADE);
+	dh = (int16_t)(target.h - current.h);
+	if (dh > COLOR_HUE_MAX / 2) {
+		dh -= COLOR_HUE_MAX;
+	}
+	if (dh < -COLOR_HUE_MAX / 2) {
+		dh += COLOR_HUE_MAX;
+	}
+
+	fade_from = current;
+	fade_to = target;
+	fade_dh = dh;
+	fade_start = get_tim2_ms();
+	fade_duration = duration_ms;
+	cs_exit(cs);
+
+	tim2_schedule(fade_start + COLOR_FRAME_MS, color_frame);
+}
+
+#define BENCH_HUE_STEP 3
+
+static const uint8_t bench_sv[][2] = {
+	{ 255, 255 }, { 255, 128 }, { 192, 255 }, { 128, 200 }, { 64, 100 },
+};
+
+// 정수 변환과 float 기준을 같은 입력으로 돌려 1회 평균 사이클과 최대 오차를 잰다
+void color_bench(color_bench_t *result)
+{
+	volatile rgbw_t sink;
+	uint32_t n = 0;
+	uint32_t start, int_cycles = 0, float_cycles = 0;
+	uint8_t max_error = 0;
+
+	for (size_t i = 0; i < sizeof(bench_sv) / sizeof(bench_sv[0]); ++i)
+	{
+		for (uint16_t h = 0; h < COLOR_HUE_MAX; h += BENCH_HUE_STEP)
+		{
+			hsv_t hsv = { h, bench_sv[i][0], bench_sv[i][1] };
+
+			start = dwt_cycles();
+			sink = hsv_to_rgb(hsv);
+			int_cycles += dwt_cycles() - start;
+
+			start = dwt_cycles();
+			sink = hsv_to_rgb_float(hsv);
+			float_cycles += dwt_cycles() - start;
+
+			rgbw_t a = hsv_to_rgb(hsv);
+			rgbw_t b = hsv_to_rgb_float(hsv);
+			uint8_t err[3] = {
+				(uint8_t)abs(a.r - b.r), (uint8_t)abs(a.g - b.g), (uint8_t)abs(a.b - b.b)
+			};
+
+			for (int c = 0; c < 3; ++c) {
+				if (err[c] > max_error) {
+					max_error = err[c];
+				}
+			}
+			n++;
+		}
+	}
+
+	(void)sink;
+	result->int_cycles = int_cycles / n;
+	result->float_cycles = float_cycles / n;
+	result->max_error = max_error;
+	result->samples = n;
+}
+
+static void color_cmd_bench(const char *args)
+{
+	color_bench_t b;
+
+	color_bench(&b);
+	console_printf("hsv: int %lu cycles, float %lu cycles, max error %u (%lu samples)\r\n",
+	               (unsigned long)b.int_cycles, (unsigned long)b.float_cycles,
+	               b.max_error, (unsigned long)b.samples);
+}
+
+static volatile bool auto_cycle = true;
+
+// "hsv H S V [ms]" H는 0~1535
+static void color_cmd_hsv(const char *args)
+{
+	unsigned h, s, v, ms = 0;
+
+	if (sscanf(args, "%u %u %u %u", &h, &s, &v, &ms) < 3 || h >= COLOR_HUE_MAX || s > 255 || v > 255)
+	{
+		console_printf("hsv: invalid\r\n");
+		return;
+	}
+
+	auto_cycle = false;
+	color_fade_to((hsv_t){ (uint16_t)h, (uint8_t)s, (uint8_t)v }, ms);
+}
+
+// 무지개를 한 구간(60도)씩 1.5초 동안 페이드하며 돈다. "hsv"를 받으면 멈춘다.
+void color_run(void)
+{
+	uint16_t hue = 0;
+	uint32_t next = get_tim2_ms();
+
+	dwt_init();
+	color_init();
+
+	console_register("hsv", color_cmd_hsv);
+	console_register("hsvbench", color_cmd_bench);
+	color_cmd_bench("");
+
+	while (1)
+	{
+		console_poll();
+
+		if (auto_cycle && (int32_t)(get_tim2_ms() - next) >= 0)
+		{
+			color_fade_to((hsv_t){ hue, 255, 255 }, 1500);
+			hue = (hue + 256) % COLOR_HUE_MAX;
+			next += 2000;
+		}
+		__WFI();
+	}
+}
@@ -0,0 +1,498 @@
+// LED 효과 바이트코드 인터프리터
+//
+// 01~05 데모처럼 효과마다 카운터를 따로 짜는 대신, 효과를 짧은 바이트코드로 적고
+// TIM2 1ms 틱에서 여러 프로그램을 동시에 돌린다. 프로그램마다 상태는 10여 바이트.
+// UART 콘솔에서 한 줄에 명령 하나씩 어셈블해서 실행 중에 올릴 수 있다.
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "00_timer2.h"
+#include "05_interrupt.h"
+#include "10_led_fx.h"
+#include "dwt.h"
+#include "gpio_fast.h"
+#include "irq_prio.h"
+#include "pwm_lut.h"
+#include "uart_console.h"
+
+// 한 틱에 연달아 실행하는 명령 수 상한 (대기 없는 무한 루프 방지)
+#define FX_MAX_STEPS 16
+
+typedef struct {
+	const uint8_t *code;   // NULL이면 멈춤
+	uint8_t len;
+	uint8_t pc;
+	uint8_t loop;          // 유한 루프 남은 횟수
+	uint8_t from;          // ramp 시작 밝기
+	uint8_t pending;       // 받은 이벤트 비트
+	uint16_t count;        // blink 남은 반주기 수
+	uint16_t timer;        // 현재 명령 남은 ms
+} fx_prog_t;
+
+extern TIM_HandleTypeDef htim2;
+
+static const uint8_t fx_size[] = { 1, 2, 4, 3, 3, 4, 2 };
+static const char *const fx_out_name[FX_OUT_COUNT] = { "ld2", "ext", "pwm" };
+
+static fx_prog_t progs[FX_MAX_PROG];
+static uint8_t fx_level[FX_OUT_COUNT];
+
+static inline uint16_t arg16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void fx_write(uint8_t out, uint8_t level)
+{
+	if (fx_level[out] == level) {
+		return;
+	}
+	fx_level[out] = level;
+
+	switch (out)
+	{
+	case FX_OUT_LD2:
+		gpio_write(LD2_GPIO_Port, LD2_Pin, level >= 128);
+		break;
+	case FX_OUT_EXT:
+		gpio_write(EXT_GPIO_Port, EXT_LED_Pin, level >= 128);
+		break;
+	default:
+		__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, pwm_lut_ccr(PWM_CURVE_GAMMA22, level));
+		break;
+	}
+}
+
+// 다음 대기 명령(wait/ramp/blink/event)까지 실행
+static void fx_exec(fx_prog_t *p)
+{
+	for (int steps = 0; steps < FX_MAX_STEPS; ++steps)
+	{
+		if (p->pc >= p->len)
+		{
+			p->code = NULL;
+			return;
+		}
+
+		const uint8_t *ins = &p->code[p->pc];
+		uint8_t op = ins[0] >> 4;
+		uint8_t out = ins[0] & 0x0F;
+
+		if (op >= sizeof(fx_size) || p->pc + fx_size[op] > p->len || out >= FX_OUT_COUNT)
+		{
+			p->code = NULL;
+			return;
+		}
+
+		switch (op)
+		{
+		case FX_OP_END:
+			p->code = NULL;
+			return;
+
+		case FX_OP_SET:
+			fx_write(out, ins[1]);
+			break;
+
+		case FX_OP_RAMP:
+			p->from = fx_level[out];
+			p->timer = arg16(&ins[2]);
+			if (p->timer > 0) {
+				return;
+			}
+			fx_write(out, ins[1]);
+			break;
+
+		case FX_OP_WAIT:
+			p->timer = arg16(&ins[1]);
+			if (p->timer > 0) {
+				return;
+			}
+			break;
+
+		case FX_OP_LOOP:
+			if (ins[1] == 0)
+			{
+				p->pc = ins[2];
+				continue;
+			}
+			if (p->loop == 0) {
+				p->loop = ins[1];
+			}
+			if (--p->loop > 0)
+			{
+				p->pc = ins[2];
+				continue;
+			}
+			break;
+
+		case FX_OP_BLINK:
+			if (ins[1] == 0 || arg16(&ins[2]) == 0) {
+				break;
+			}
+			fx_write(out, 255);
+			p->count = (uint16_t)(ins[1] * 2);
+			p->timer = arg16(&ins[2]);
+			return;
+
+		case FX_OP_EVENT:
+		{
+			uint32_t cs = cs_enter(CS_FX_EVENTS);
+			bool got = (p->pending & ins[1]) != 0;
+
+			// 확인과 지우기 사이에 fx_post_event가 끼면 새 이벤트가 같이 지워진다
+			if (got) {
+				p->pending &= (uint8_t)~ins[1];
+			}
+			cs_exit(cs);
+			if (!got) {
+				return;
+			}
+			break;
+		}
+		}
+
+		p->pc += fx_size[op];
+	}
+}
+
+// 진행 중인 ramp/blink/wait를 1ms 진행시키고, 끝났으면 다음 명령으로
+static void fx_step(fx_prog_t *p)
+{
+	if (p->timer > 0)
+	{
+		const uint8_t *ins = &p->code[p->pc];
+		uint8_t op = ins[0] >> 4;
+		uint8_t out = ins[0] & 0x0F;
+
+		p->timer--;
+
+		if (op == FX_OP_RAMP)
+		{
+			uint16_t total = arg16(&ins[2]);
+			int32_t delta = (int32_t)ins[1] - p->from;
+
+			fx_write(out, (uint8_t)(p->from + delta * (total - p->timer) / total));
+		}
+
+		if (p->timer > 0) {
+			return;
+		}
+
+		if (op == FX_OP_BLINK)
+		{
+			if (--p->count > 0)
+			{
+				fx_write(out, (p->count & 1) ? 0 : 255);
+				p->timer = arg16(&ins[2]);
+				return;
+			}
+			fx_write(out, 0);
+		}
+
+		p->pc += fx_size[op];
+	}
+
+	fx_exec(p);
+}
+
+// TIM2 1ms 콜백
+void fx_tick(void)
+{
+	for (int i = 0; i < FX_MAX_PROG; ++i) {
+		if (progs[i].code != NULL) {
+			fx_step(&progs[i]);
+		}
+	}
+}
+
+// code는 실행하는 동안 그대로 있어야 한다 (플래시 상수나 정적 버퍼)
+int fx_load(uint8_t slot, const uint8_t *code, uint8_t len)
+{
+	uint32_t cs;
+
+	if (slot >= FX_MAX_PROG || code == NULL || len == 0) {
+		return -1;
+	}
+
+	cs = cs_enter(CS_FX_PROGS);
+	memset(&progs[slot], 0, sizeof(progs[slot]));
+	progs[slot].code = code;
+	progs[slot].len = len;
+	cs_exit(cs);
+	return 0;
+}
+
+void fx_stop(uint8_t slot)
+{
+	if (slot < FX_MAX_PROG) {
+		progs[slot].code = NULL;
+	}
+}
+
+// 실행 중인 모든 프로그램에 이벤트 비트를 건넨다. EXTI 레벨까지의 ISR에서 불러도 된다
+void fx_post_event(uint8_t mask)
+{
+	uint32_t cs = cs_enter(CS_FX_EVENTS);
+
+	for (int i = 0; i < FX_MAX_PROG; ++i) {
+		if (progs[i].code != NULL) {
+			progs[i].pending |= mask;
+		}
+	}
+	cs_exit(cs);
+}
+
+// index번째 명령의 바이트 주소
+static int fx_addr_of(const uint8_t *code, uint8_t len, unsigned index)
+{
+	uint8_t addr = 0;
+
+	while (index-- > 0)
+	{
+		if (addr >= len) {
+			return -1;
+		}
+		addr += fx_size[code[addr] >> 4];
+	}
+	return (addr < len) ? addr : -1;
+}
+
+static int fx_parse_out(const char *name)
+{
+	for (int i = 0; i < FX_OUT_COUNT; ++i) {
+		if (strcmp(fx_out_name[i], name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// 어셈블러: "ramp pwm 255 1000" 같은 한 줄을 code 끝에 붙인다.
+// loop의 두 번째 인자는 바이트 주소가 아니라 명령 번호(0부터)
+int fx_asm_line(uint8_t *code, uint8_t *len, const char *line)
+{
+	char op[8], out_name[8];
+	unsigned a = 0, b = 0;
+	uint8_t ins[4];
+	int out = 0;
+	int n;
+
+	if (sscanf(line, "%7s", op) != 1) {
+		return -1;
+	}
+
+	if (strcmp(op, "set") == 0 && sscanf(line, "%*s %7s %u", out_name, &a) == 2 && a <= 255)
+	{
+		out = fx_parse_out(out_name);
+		ins[0] = (uint8_t)((FX_OP_SET << 4) | out);
+		ins[1] = (uint8_t)a;
+		n = 2;
+	}
+	else if ((strcmp(op, "ramp") == 0 || strcmp(op, "blink") == 0)
+	         && sscanf(line, "%*s %7s %u %u", out_name, &a, &b) == 3 && a <= 255 && b <= 0xFFFF)
+	{
+		out = fx_parse_out(out_name);
+		ins[0] = (uint8_t)((((op[0] == 'r') ? FX_OP_RAMP : FX_OP_BLINK) << 4) | out);
+		ins[1] = (uint8_t)a;
+		ins[2] = (uint8_t)(b & 0xFF);
+		ins[3] = (uint8_t)(b >> 8);
+		n = 4;
+	}
+	else if (strcmp(op, "wait") == 0 && sscanf(line, "%*s %u", &a) == 1 && a <= 0xFFFF)
+	{
+		ins[0] = FX_OP_WAIT << 4;
+		ins[1] = (uint8_t)(a & 0xFF);
+		ins[2] = (uint8_t)(a >> 8);
+		n = 3;
+	}
+	else if (strcmp(op, "loop") == 0 && sscanf(line, "%*s %u %u", &a, &b) == 2 && a <= 255)
+	{
+		int addr = fx_addr_of(code, *len, b);
+		if (addr < 0) {
+			return -1;
+		}
+		ins[0] = FX_OP_LOOP << 4;
+		ins[1] = (uint8_t)a;
+		ins[2] = (uint8_t)addr;
+		n = 3;
+	}
+	else if (strcmp(op, "event") == 0 && sscanf(line, "%*s %u", &a) == 1 && a <= 255)
+	{
+		ins[0] = FX_OP_EVENT << 4;
+		ins[1] = (uint8_t)a;
+		n = 2;
+	}
+	else if (strcmp(op, "end") == 0)
+	{
+		ins[0] = FX_END;
+		n = 1;
+	}
+	else
+	{
+		return -1;
+	}
+
+	if (out < 0 || *len + n > FX_CODE_MAX) {
+		return -1;
+	}
+
+	memcpy(&code[*len], ins, n);
+	*len += n;
+	return n;
+}
+
+// 01/02 0.5초 깜빡임, 03 숨쉬기, 05 버튼 누르면 외부 LED 2초
+static const uint8_t fx_blink500[] = {
+	FX_SET(FX_OUT_LD2, 255), FX_WAIT(500), FX_SET(FX_OUT_LD2, 0), FX_WAIT(500), FX_LOOP(0, 0),
+};
+static const uint8_t fx_breathe[] = {
+	FX_RAMP(FX_OUT_PWM, 255, 1000), FX_RAMP(FX_OUT_PWM, 0, 1000), FX_LOOP(0, 0),
+};
+static const uint8_t fx_button[] = {
+	FX_EVENT(1), FX_SET(FX_OUT_EXT, 255), FX_WAIT(2000), FX_SET(FX_OUT_EXT, 0), FX_LOOP(0, 0),
+};
+
+// 콘솔에서 편집하는 슬롯별 프로그램
+static uint8_t fx_src[FX_MAX_PROG][FX_CODE_MAX];
+static uint8_t fx_src_len[FX_MAX_PROG];
+
+static int fx_parse_slot(const char **args)
+{
+	unsigned slot;
+	int used;
+
+	if (sscanf(*args, "%u%n", &slot, &used) != 1 || slot >= FX_MAX_PROG) {
+		return -1;
+	}
+	*args += used;
+	return (int)slot;
+}
+
+// "fx N ramp pwm 255 500" 슬롯 N 편집 버퍼에 한 명령 추가
+static void fx_cmd_asm(const char *args)
+{
+	int slot = fx_parse_slot(&args);
+
+	if (slot < 0 || fx_asm_line(fx_src[slot], &fx_src_len[slot], args) < 0)
+	{
+		console_printf("fx: invalid\r\n");
+		return;
+	}
+	console_printf("fx %d: %u bytes\r\n", slot, fx_src_len[slot]);
+}
+
+static void fx_cmd_clear(const char *args)
+{
+	int slot = fx_parse_slot(&args);
+
+	if (slot >= 0)
+	{
+		fx_stop((uint8_t)slot);
+		fx_src_len[slot] = 0;
+	}
+}
+
+static void fx_cmd_run(const char *args)
+{
+	int slot = fx_parse_slot(&args);
+
+	if (slot < 0 || fx_load((uint8_t)slot, fx_src[slot], fx_src_len[slot]) < 0) {
+		console_printf("fxrun: invalid\r\n");
+	}
+}
+
+static void fx_cmd_stop(const char *args)
+{
+	int slot = fx_parse_slot(&args);
+
+	if (slot >= 0) {
+		fx_stop((uint8_t)slot);
+	}
+}
+
+static void fx_cmd_event(const char *args)
+{
+	unsigned mask;
+
+	if (sscanf(args, "%u", &mask) == 1) {
+		fx_post_event((uint8_t)mask);
+	}
+}
+
+#define FX_BENCH_TICKS 1000
+
+// 모든 슬롯에서 숨쉬기(매 틱 ramp 계산)를 돌려 틱당 사이클을 잰다.
+// 인터럽트를 막고 fx_tick을 직접 부르며, 끝나면 슬롯을 되돌린다.
+static void fx_cmd_bench(const char *args)
+{
+	fx_prog_t saved[FX_MAX_PROG];
+	uint32_t primask = __get_PRIMASK();
+	uint32_t idle, busy, start;
+
+	__disable_irq();
+	memcpy(saved, progs, sizeof(progs));
+
+	memset(progs, 0, sizeof(progs));
+	start = dwt_cycles();
+	for (int t = 0; t < FX_BENCH_TICKS; ++t) {
+		fx_tick();
+	}
+	idle = dwt_cycles() - start;
+
+	for (int i = 0; i < FX_MAX_PROG; ++i)
+	{
+		progs[i].code = fx_breathe;
+		progs[i].len = sizeof(fx_breathe);
+	}
+	start = dwt_cycles();
+	for (int t = 0; t < FX_BENCH_TICKS; ++t) {
+		fx_tick();
+	}
+	busy = dwt_cycles() - start;
+
+	memcpy(progs, saved, sizeof(progs));
+	__set_PRIMASK(primask);
+
+	console_printf("fxbench: idle %lu cycles/tick, %d progs %lu cycles/tick, %lu cycles/prog\r\n",
+	               (unsigned long)(idle / FX_BENCH_TICKS), FX_MAX_PROG,
+	               (unsigned long)(busy / FX_BENCH_TICKS),
+	               (unsigned long)((busy - idle) / FX_BENCH_TICKS / FX_MAX_PROG));
+}
+
+// 기존 LED 데모 세 개를 바이트코드로 동시에 돌린다. 버튼은 폴링해서 이벤트 1로 보낸다
+void fx_run(void)
+{
+	bool last = true;
+
+	dwt_init();
+	// 출력 밝기는 모두 0에서 시작
+	__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, pwm_lut_ccr(PWM_CURVE_GAMMA22, 0));
+	HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
+
+	fx_load(0, fx_blink500, sizeof(fx_blink500));
+	fx_load(1, fx_breathe, sizeof(fx_breathe));
+	fx_load(2, fx_button, sizeof(fx_button));
+	tim2_register_callback(fx_tick);
+
+	console_register("fx", fx_cmd_asm);
+	console_register("fxclr", fx_cmd_clear);
+	console_register("fxrun", fx_cmd_run);
+	console_register("fxstop", fx_cmd_stop);
+	console_register("fxev", fx_cmd_event);
+	console_register("fxbench", fx_cmd_bench);
+
+	while (1)
+	{
+		bool now = gpio_read(B1_GPIO_Port, B1_Pin);
+
+		if (last && !now) {
+			fx_post_event(1);
+		}
+		last = now;
+
+		console_poll();
+		__WFI();
+	}
+}
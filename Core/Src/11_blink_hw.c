@@ -0,0 +1,245 @@
+// 인터럽트 없이 하드웨어만으로 LED 깜빡이기
+//
+// 02_led_timer는 1ms 인터럽트를 500번 세서 한 번 토글한다 (초당 IRQ 1000번).
+// 여기서는 타이머가 직접 핀을 움직인다.
+//  - PC6/PC8/PC9: TIM3 CH1/CH3/CH4 PWM 모드 1 출력 (AF2). 세 채널은 주기를 공유한다.
+//  - PA5(LD2): 타이머 핀 기능이 없어서 TIM1 업데이트/CC1 DMA 요청으로 BSRR에 켜기/끄기 워드를 쓴다.
+//    GPIO는 AHB1에 있어서 DMA1로는 닿지 않으므로 DMA2(Stream5 = TIM1_UP, Stream1 = TIM1_CH1, 채널 6)를 쓴다.
+// 두 경우 모두 설정 후에는 CPU가 할 일이 없다.
+
+#include "main.h"
+#include "00_timer2.h"
+#include "02_led_timer.h"
+#include "11_blink_hw.h"
+#include "dwt.h"
+#include "gpio_fast.h"
+#include "uart_console.h"
+
+// 84MHz / 8400 = 10kHz, 카운트 하나가 0.1ms
+#define BLINK_PSC 8399
+#define TICKS_PER_MS 10
+
+extern TIM_HandleTypeDef htim2;
+
+static TIM_HandleTypeDef htim1;
+static TIM_HandleTypeDef htim3;
+static DMA_HandleTypeDef hdma_tim1_up;
+static DMA_HandleTypeDef hdma_tim1_cc1;
+
+static const uint32_t ld2_on = LD2_Pin;
+static const uint32_t ld2_off = (uint32_t)LD2_Pin << 16;
+
+static const uint16_t tim3_pin[BLINK_HW_COUNT] = { 0, GPIO_PIN_6, GPIO_PIN_8, GPIO_PIN_9 };
+static const uint32_t tim3_channel[BLINK_HW_COUNT] = { 0, TIM_CHANNEL_1, TIM_CHANNEL_3, TIM_CHANNEL_4 };
+
+static bool initialized = false;
+static uint8_t tim3_active = 0;        // 돌고 있는 TIM3 채널 비트
+static uint16_t tim3_period_ms = 0;
+
+static void dma_init(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *stream)
+{
+	hdma->Instance = stream;
+	hdma->Init.Channel = DMA_CHANNEL_6;
+	hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma->Init.MemInc = DMA_MINC_DISABLE;
+	hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	hdma->Init.Mode = DMA_CIRCULAR;
+	hdma->Init.Priority = DMA_PRIORITY_LOW;
+	hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(hdma) != HAL_OK)
+	{
+		Error_Handler();
+	}
+}
+
+static void blink_hw_init(void)
+{
+	TIM_OC_InitTypeDef sConfigOC = {0};
+
+	__HAL_RCC_TIM1_CLK_ENABLE();
+	__HAL_RCC_TIM3_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	htim1.Instance = TIM1;
+	htim1.Init.Prescaler = BLINK_PSC;
+	htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim1.Init.Period = 9999;
+	htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim1.Init.RepetitionCounter = 0;
+	htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_Base_Init(&htim1) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	// CC1은 핀 없이 DMA 요청만 만든다
+	sConfigOC.OCMode = TIM_OCMODE_TIMING;
+	sConfigOC.Pulse = 0;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	HAL_TIM_OC_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_1);
+
+	dma_init(&hdma_tim1_up, DMA2_Stream5);
+	dma_init(&hdma_tim1_cc1, DMA2_Stream1);
+
+	htim3.Instance = TIM3;
+	htim3.Init.Prescaler = BLINK_PSC;
+	htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim3.Init.Period = 9999;
+	htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_PWM_Init(&htim3) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	initialized = true;
+}
+
+static void gpio_set_mode(blink_hw_pin_t pin, bool timer)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	GPIO_InitStruct.Pin = tim3_pin[pin];
+	GPIO_InitStruct.Mode = timer ? GPIO_MODE_AF_PP : GPIO_MODE_OUTPUT_PP;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Alternate = timer ? GPIO_AF2_TIM3 : 0;
+	gpio_clear(GPIOC, tim3_pin[pin]);
+	HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
+}
+
+// duty_ms 동안 켜지고 나머지는 꺼진 채로 period_ms마다 반복.
+// TIM3 핀들은 주기를 공유하므로 다른 TIM3 핀이 돌고 있으면 같은 주기만 받는다.
+bool blink_hw_start(blink_hw_pin_t pin, uint16_t period_ms, uint16_t duty_ms)
+{
+	uint32_t arr = (uint32_t)period_ms * TICKS_PER_MS - 1;
+	uint32_t ccr = (uint32_t)duty_ms * TICKS_PER_MS;
+
+	if (pin >= BLINK_HW_COUNT || period_ms == 0 || period_ms > BLINK_HW_MAX_PERIOD_MS)
+	{
+		return false;
+	}
+	if (!initialized) {
+		blink_hw_init();
+	}
+
+	if (pin == BLINK_HW_LD2)
+	{
+		blink_hw_stop(pin);
+		if (duty_ms == 0 || duty_ms >= period_ms)
+		{
+			gpio_write(LD2_GPIO_Port, LD2_Pin, duty_ms != 0);
+			return true;
+		}
+
+		__HAL_TIM_SET_AUTORELOAD(&htim1, arr);
+		__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, ccr);
+		__HAL_TIM_SET_COUNTER(&htim1, 0);
+
+		HAL_DMA_Start(&hdma_tim1_up, (uint32_t)&ld2_on, (uint32_t)&LD2_GPIO_Port->BSRR, 1);
+		HAL_DMA_Start(&hdma_tim1_cc1, (uint32_t)&ld2_off, (uint32_t)&LD2_GPIO_Port->BSRR, 1);
+		__HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE | TIM_DMA_CC1);
+
+		// UG로 업데이트 요청을 한 번 내서 첫 주기부터 켜진 상태로 시작
+		htim1.Instance->EGR = TIM_EGR_UG;
+		__HAL_TIM_ENABLE(&htim1);
+		return true;
+	}
+
+	if ((tim3_active & ~(1U << pin)) && period_ms != tim3_period_ms)
+	{
+		return false;
+	}
+
+	// PWM 모드 1: CNT < CCR 동안 켜짐. CCR > ARR 이면 항상 켜짐
+	if (duty_ms >= period_ms) {
+		ccr = arr + 1;
+	}
+
+	if (tim3_active == 0)
+	{
+		__HAL_TIM_SET_AUTORELOAD(&htim3, arr);
+		__HAL_TIM_SET_COUNTER(&htim3, 0);
+		tim3_period_ms = period_ms;
+	}
+
+	TIM_OC_InitTypeDef sConfigOC = {0};
+	sConfigOC.OCMode = TIM_OCMODE_PWM1;
+	sConfigOC.Pulse = ccr;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	HAL_TIM_PWM_ConfigChannel(&htim3, &sConfigOC, tim3_channel[pin]);
+
+	gpio_set_mode(pin, true);
+	HAL_TIM_PWM_Start(&htim3, tim3_channel[pin]);
+	tim3_active |= 1U << pin;
+	return true;
+}
+
+void blink_hw_stop(blink_hw_pin_t pin)
+{
+	if (pin >= BLINK_HW_COUNT || !initialized) {
+		return;
+	}
+
+	if (pin == BLINK_HW_LD2)
+	{
+		__HAL_TIM_DISABLE(&htim1);
+		__HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE | TIM_DMA_CC1);
+		HAL_DMA_Abort(&hdma_tim1_up);
+		HAL_DMA_Abort(&hdma_tim1_cc1);
+		gpio_clear(LD2_GPIO_Port, LD2_Pin);
+		return;
+	}
+
+	if (tim3_active & (1U << pin))
+	{
+		HAL_TIM_PWM_Stop(&htim3, tim3_channel[pin]);
+		gpio_set_mode(pin, false);
+		tim3_active &= ~(1U << pin);
+	}
+}
+
+// 1초 동안 들어온 TIM2/SysTick 인터럽트 수를 출력한다.
+// 인터럽트가 없어도 잴 수 있도록 DWT 사이클로 1초를 세며 바쁜 대기한다.
+static void report_irq_rate(const char *label, int seconds)
+{
+	for (int i = 0; i < seconds; ++i)
+	{
+		uint32_t tim2_start = get_tim2_ms();
+		uint32_t systick_start = HAL_GetTick();
+		uint32_t start = dwt_cycles();
+
+		while (dwt_cycles() - start < SystemCoreClock) {}
+
+		console_printf("%s: tim2 %lu irq/s, systick %lu irq/s\r\n", label,
+		               (unsigned long)(get_tim2_ms() - tim2_start),
+		               (unsigned long)(HAL_GetTick() - systick_start));
+	}
+}
+
+// 02 방식(1ms 인터럽트로 세기)과 하드웨어 깜빡임의 초당 인터럽트 수 비교
+void blink_hw_run(void)
+{
+	dwt_init();
+
+	led_timer_run();
+	report_irq_rate("sw", 3);
+
+	// TIM2 틱과 HAL SysTick까지 끄고 나면 깜빡임에 쓰이는 인터럽트는 0
+	tim2_unregister_all();
+	HAL_TIM_Base_Stop_IT(&htim2);
+	HAL_SuspendTick();
+
+	blink_hw_start(BLINK_HW_LD2, 1000, 500);
+	blink_hw_start(BLINK_HW_GREEN, 2000, 1000);
+	blink_hw_start(BLINK_HW_YELLOW, 2000, 200);
+
+	while (1)
+	{
+		report_irq_rate("hw", 1);
+	}
+}
@@ -0,0 +1,386 @@
+// TIM2_CH1 샘플 재생 (부저 톤, 알림음, LED 깜빡임 시퀀스)
+//
+// PSC/ARR을 샘플레이트와 해상도에 맞게 다시 잡고, TIM2 업데이트마다 DMA1 Stream7(채널 3, TIM2_UP)이
+// 핑퐁 버퍼에서 CCR1로 샘플 하나를 쓴다. 반쪽을 다 읽으면(HT/TC) ISR은 그 반쪽이 비었다고
+// 표시만 하고, 실제 채우기는 메인 루프의 pcm_service()가 한다. 그래서 채우기가 반쪽 버퍼
+// 길이만큼 늦어도 소리는 끊기지 않고, 그보다 늦으면 언더런으로 센다.
+//
+// 재생 중에는 TIM2 업데이트가 1ms가 아니므로 업데이트 인터럽트를 끄고,
+// 재생한 샘플 수로 경과 시간을 계산해 tim2_advance()로 ms 틱을 이어 간다.
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "00_timer2.h"
+#include "bitband.h"
+#include "12_pcm.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include "pwm_lut.h"
+#include "uart_console.h"
+
+#define DMA1_S7_FLAGS (DMA_HIFCR_CTCIF7 | DMA_HIFCR_CHTIF7 | DMA_HIFCR_CTEIF7 \
+                       | DMA_HIFCR_CDMEIF7 | DMA_HIFCR_CFEIF7)
+
+extern TIM_HandleTypeDef htim2;
+static DMA_HandleTypeDef hdma_pcm;
+
+static uint32_t pcm_buf[PCM_BUF_SAMPLES];
+
+static pcm_fill_t pcm_fill = NULL;
+static flagset_t free_halves;              // 비어서 채워야 하는 반쪽 (비트 0, 1)
+static uint8_t next_half = 0;              // 다음에 채울 반쪽
+static volatile uint32_t free_at[2];       // 반쪽이 빈 시각 (DWT)
+
+static uint32_t tim_clock_hz;
+static uint64_t clocks_per_half;           // 반쪽 재생에 걸리는 타이머 클럭 수
+static uint64_t clock_acc = 0;
+
+static pcm_stats_t stats;
+
+static void pcm_init(void)
+{
+	static bool initialized = false;
+
+	if (initialized) {
+		return;
+	}
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	hdma_pcm.Instance = DMA1_Stream7;
+	hdma_pcm.Init.Channel = DMA_CHANNEL_3;
+	hdma_pcm.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma_pcm.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_pcm.Init.MemInc = DMA_MINC_ENABLE;
+	// TIM2 CCR은 32비트라 샘플도 워드로 둔다
+	hdma_pcm.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	hdma_pcm.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	hdma_pcm.Init.Mode = DMA_CIRCULAR;
+	hdma_pcm.Init.Priority = DMA_PRIORITY_HIGH;
+	hdma_pcm.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(&hdma_pcm) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	HAL_NVIC_SetPriority(DMA1_Stream7_IRQn, IRQ_PRIO_STREAM, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Stream7_IRQn);
+
+	// APB1 분주가 1이 아니면 타이머 클럭은 PCLK1 x 2
+	tim_clock_hz = HAL_RCC_GetPCLK1Freq() * 2;
+	initialized = true;
+}
+
+static void refill(uint8_t half)
+{
+	uint32_t late = dwt_cycles() - free_at[half];
+
+	pcm_fill(&pcm_buf[half * PCM_HALF_SAMPLES], PCM_HALF_SAMPLES);
+
+	late = dwt_cycles_to_ns(late) / 1000;
+	if (late > stats.late_max_us) {
+		stats.late_max_us = late;
+	}
+	stats.halves++;
+
+	// 비트 밴드 쓰기라 DMA ISR이 다른 반쪽 비트를 세우는 것과 겹쳐도 안전하다
+	flag_clear(&free_halves, half);
+}
+
+// steps는 PWM 단계 수(ARR + 1). 타이머 클럭 / (rate x steps)가 PSC 범위 안이어야 한다.
+// 재생 중이면 멈추고 새로 시작한다.
+bool pcm_start(uint32_t rate_hz, uint32_t steps, pcm_fill_t fill)
+{
+	uint64_t clocks;   // rate x steps는 32비트를 넘을 수 있다
+	uint32_t psc;
+
+	pcm_init();
+
+	if (fill == NULL || rate_hz == 0 || steps < 2 || steps > 0x10000)
+	{
+		return false;
+	}
+
+	clocks = (uint64_t)rate_hz * steps;
+	psc = (uint32_t)((tim_clock_hz + clocks / 2) / clocks);
+	if (psc == 0 || psc > 0x10000)
+	{
+		return false;
+	}
+
+	pcm_stop();
+
+	memset(&stats, 0, sizeof(stats));
+	stats.rate_hz = (uint32_t)(tim_clock_hz / ((uint64_t)psc * steps));
+	stats.steps = steps;
+
+	// 시작 전에 양쪽을 다 채워 둔다
+	pcm_fill = fill;
+	pcm_fill(pcm_buf, PCM_BUF_SAMPLES);
+	free_halves.bits = 0;
+	next_half = 0;
+	clocks_per_half = (uint64_t)psc * steps * PCM_HALF_SAMPLES;
+	clock_acc = 0;
+
+	__HAL_TIM_DISABLE(&htim2);
+	__HAL_TIM_DISABLE_IT(&htim2, TIM_IT_UPDATE);
+	htim2.Instance->PSC = psc - 1;
+	htim2.Instance->ARR = steps - 1;
+	htim2.Instance->CCR1 = pcm_buf[0];
+	htim2.Instance->EGR = TIM_EGR_UG;
+	__HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+
+	HAL_DMA_Start(&hdma_pcm, (uint32_t)pcm_buf, (uint32_t)&htim2.Instance->CCR1, PCM_BUF_SAMPLES);
+	hdma_pcm.Instance->CR |= DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+	__HAL_TIM_ENABLE_DMA(&htim2, TIM_DMA_UPDATE);
+	HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
+	__HAL_TIM_ENABLE(&htim2);
+	return true;
+}
+
+// 원래의 1ms 틱(PSC 83, ARR 999)으로 되돌린다
+void pcm_stop(void)
+{
+	if (pcm_fill == NULL) {
+		return;
+	}
+
+	__HAL_TIM_DISABLE_DMA(&htim2, TIM_DMA_UPDATE);
+	hdma_pcm.Instance->CR &= ~(DMA_SxCR_HTIE | DMA_SxCR_TCIE);
+	HAL_DMA_Abort(&hdma_pcm);
+	pcm_fill = NULL;
+
+	__HAL_TIM_DISABLE(&htim2);
+	htim2.Instance->PSC = htim2.Init.Prescaler;
+	htim2.Instance->ARR = htim2.Init.Period;
+	htim2.Instance->CCR1 = 0;
+	htim2.Instance->EGR = TIM_EGR_UG;
+	__HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+	__HAL_TIM_ENABLE_IT(&htim2, TIM_IT_UPDATE);
+	__HAL_TIM_ENABLE(&htim2);
+}
+
+// 메인 루프에서 호출. 빈 반쪽을 순서대로 채운다
+void pcm_service(void)
+{
+	while (pcm_fill != NULL && flag_test(&free_halves, next_half))
+	{
+		refill(next_half);
+		next_half ^= 1;
+	}
+}
+
+static void half_done(uint8_t half)
+{
+	// DMA가 지금 읽기 시작한 반대쪽이 아직 안 채워졌으면 지난 데이터를 한 번 더 재생한다
+	if (flag_test(&free_halves, half ^ 1)) {
+		stats.underruns++;
+	}
+	flag_raise(&free_halves, half);
+	free_at[half] = dwt_cycles();
+
+	clock_acc += clocks_per_half;
+	tim2_advance(clock_acc / (tim_clock_hz / 1000));
+	clock_acc %= tim_clock_hz / 1000;
+}
+
+// DMA1_Stream7_IRQHandler에서 호출
+void pcm_dma_irq(void)
+{
+	uint32_t isr = DMA1->HISR;
+
+	DMA1->HIFCR = DMA1_S7_FLAGS;
+
+	if (isr & DMA_HISR_HTIF7) {
+		half_done(0);
+	}
+	if (isr & DMA_HISR_TCIF7) {
+		half_done(1);
+	}
+}
+
+void pcm_get_stats(pcm_stats_t *out)
+{
+	*out = stats;
+}
+
+// 사인 한 주기 512칸: 앞 256칸은 pwm_lut 사인 곡선(0 -> 1000), 뒤는 거꾸로
+static inline uint32_t sine512(uint32_t i)
+{
+	return pwm_lut_ccr(PWM_CURVE_SINE, (uint8_t)((i < 256) ? i : 511 - i));
+}
+
+static uint32_t tone_freq = 440;
+static uint32_t tone_phase = 0;
+static uint32_t chime_env = 0;             // Q16 진폭
+static uint32_t rng = 0x1234567;
+
+// 위상 증가량 (2^32 = 한 주기)
+static uint32_t tone_inc(void)
+{
+	return (uint32_t)(((uint64_t)tone_freq << 32) / stats.rate_hz);
+}
+
+// 50% 듀티를 중심으로 하는 사인 (부저)
+static void fill_tone(uint32_t *dst, uint16_t count)
+{
+	uint32_t steps = stats.steps;
+	uint32_t inc = tone_inc();
+
+	for (uint16_t i = 0; i < count; ++i)
+	{
+		dst[i] = sine512(tone_phase >> 23) * (steps - 1) / PWM_LUT_FULL;
+		tone_phase += inc;
+	}
+}
+
+// 톤과 같지만 진폭이 지수적으로 줄어든다 (샘플마다 1/2048씩)
+static void fill_chime(uint32_t *dst, uint16_t count)
+{
+	int32_t mid = (int32_t)stats.steps / 2;
+	uint32_t inc = tone_inc();
+
+	for (uint16_t i = 0; i < count; ++i)
+	{
+		int32_t s = (int32_t)sine512(tone_phase >> 23) - PWM_LUT_FULL / 2;
+
+		dst[i] = (uint32_t)(mid + (int32_t)(((int64_t)s * mid / (PWM_LUT_FULL / 2) * chime_env) >> 16));
+		tone_phase += inc;
+		chime_env -= chime_env >> 11;
+	}
+}
+
+// 촛불처럼 일렁이는 LED. 무작위 목표값을 저역 통과시켜 감마 보정
+static void fill_flicker(uint32_t *dst, uint16_t count)
+{
+	static uint32_t level = 180 << 8;
+	static uint32_t target = 180 << 8;
+
+	for (uint16_t i = 0; i < count; ++i)
+	{
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+
+		if ((rng & 0x3F) == 0) {
+			target = (120 + (rng >> 24) % 136) << 8;
+		}
+		level += ((int32_t)target - (int32_t)level) / 32;
+		dst[i] = pwm_lut_ccr(PWM_CURVE_GAMMA22, (uint8_t)(level >> 8)) * (stats.steps - 1) / PWM_LUT_FULL;
+	}
+}
+
+// 부저용 16kHz 부근, 256단계
+#define PCM_AUDIO_RATE 16000
+#define PCM_AUDIO_STEPS 256
+
+static void pcm_cmd_tone(const char *args)
+{
+	unsigned freq;
+
+	if (sscanf(args, "%u", &freq) != 1 || freq == 0 || freq >= PCM_AUDIO_RATE / 2)
+	{
+		console_printf("tone: invalid\r\n");
+		return;
+	}
+	tone_freq = freq;
+	tone_phase = 0;
+	pcm_start(PCM_AUDIO_RATE, PCM_AUDIO_STEPS, fill_tone);
+}
+
+static void pcm_cmd_chime(const char *args)
+{
+	unsigned freq = 880;
+
+	sscanf(args, "%u", &freq);
+	tone_freq = freq;
+	tone_phase = 0;
+	chime_env = 1U << 16;
+	pcm_start(PCM_AUDIO_RATE, PCM_AUDIO_STEPS, fill_chime);
+}
+
+// LED는 원래 PWM과 같은 1kHz, 1000단계
+static void pcm_cmd_flicker(const char *args)
+{
+	pcm_start(1000, 1000, fill_flicker);
+}
+
+static void pcm_cmd_stop(const char *args)
+{
+	pcm_stop();
+}
+
+static void pcm_cmd_stats(const char *args)
+{
+	console_printf("pcm: %lu Hz x %lu steps, %lu halves, %lu underruns, late max %lu us\r\n",
+	               (unsigned long)stats.rate_hz, (unsigned long)stats.steps,
+	               (unsigned long)stats.halves, (unsigned long)stats.underruns,
+	               (unsigned long)stats.late_max_us);
+}
+
+#define PCM_BENCH_HALVES 64
+
+// 반쪽 채우기(톤 생성 + 관리) 비용을 재고, CPU 절반을 쓸 때 낼 수 있는 최대 샘플레이트를 계산
+static void pcm_cmd_bench(const char *args)
+{
+	static const struct {
+		const char *name;
+		pcm_fill_t fill;
+	} fills[] = {
+		{ "tone", fill_tone }, { "chime", fill_chime }, { "flicker", fill_flicker },
+	};
+	uint32_t scratch[PCM_HALF_SAMPLES];
+	pcm_stats_t saved = stats;
+	uint32_t saved_phase = tone_phase, saved_env = chime_env, saved_rng = rng;
+
+	// 재생 중에는 채우기 함수의 상태를 같이 쓰고, 바쁜 루프 동안 pcm_service도 못 돈다
+	if (pcm_fill != NULL)
+	{
+		console_printf("pcmbench: stop playback first\r\n");
+		return;
+	}
+	// 부저 설정을 빌려 쓴다
+	stats.rate_hz = PCM_AUDIO_RATE;
+	stats.steps = PCM_AUDIO_STEPS;
+
+	for (size_t f = 0; f < sizeof(fills) / sizeof(fills[0]); ++f)
+	{
+		uint32_t start = dwt_cycles();
+
+		for (int i = 0; i < PCM_BENCH_HALVES; ++i) {
+			fills[f].fill(scratch, PCM_HALF_SAMPLES);
+		}
+
+		uint32_t per_sample = (dwt_cycles() - start) / (PCM_BENCH_HALVES * PCM_HALF_SAMPLES);
+		console_printf("pcmbench %s: %lu cycles/sample, max %lu Hz at 50%% cpu\r\n", fills[f].name,
+		               (unsigned long)per_sample,
+		               (unsigned long)(SystemCoreClock / 2 / (per_sample ? per_sample : 1)));
+	}
+	stats.rate_hz = saved.rate_hz;
+	stats.steps = saved.steps;
+	tone_phase = saved_phase;
+	chime_env = saved_env;
+	rng = saved_rng;
+}
+
+void pcm_run(void)
+{
+	dwt_init();
+
+	console_register("tone", pcm_cmd_tone);
+	console_register("chime", pcm_cmd_chime);
+	console_register("flicker", pcm_cmd_flicker);
+	console_register("pcmstop", pcm_cmd_stop);
+	console_register("pcm", pcm_cmd_stats);
+	console_register("pcmbench", pcm_cmd_bench);
+
+	pcm_cmd_flicker("");
+
+	while (1)
+	{
+		console_poll();
+		pcm_service();
+		__WFI();
+	}
+}
@@ -0,0 +1,336 @@
+// 타이머 입력 캡처로 엣지 시각 기록 (버튼 누름 길이, 펄스폭, 차량 검지기 펄스열)
+//
+// EXTI 콜백에서 get_tim2_ms()로 찍으면 1ms 단위에 ISR 지연까지 섞인다.
+// 여기서는 PA1(TIM5_CH2 입력, TI2)을 32비트 TIM5 두 채널에 함께 물린다.
+// CH1은 TI2 상승 엣지, CH2는 TI2 하강 엣지에서 카운터 값을 하드웨어가 잡고,
+// DMA1 Stream2(TIM5_CH1)/Stream4(TIM5_CH2, 둘 다 채널 6)가 엣지 종류별 순환 링으로 옮긴다.
+// 엣지마다 인터럽트는 없고 링이 한 바퀴 돌 때(TC)만 바퀴 수를 센다.
+
+#include <stdio.h>
+#include "main.h"
+#include "13_icap.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include "uart_console.h"
+
+#define RING_RISE 0
+#define RING_FALL 1
+#define PEEK_MARGIN (ICAP_RING_LEN / 2)   // 뒤처졌을 때 머리에서 이만큼 뒤로 건너뛴다
+#define PEEK_TRIES 4
+
+typedef struct {
+	DMA_HandleTypeDef hdma;
+	volatile uint32_t *isr;    // DMA LISR/HISR
+	volatile uint32_t *ifcr;
+	uint32_t tcif;
+	volatile uint32_t laps;    // TC 인터럽트가 센 바퀴 수
+	uint32_t read;             // 지금까지 읽어 간 개수
+	uint32_t buf[ICAP_RING_LEN];
+} icap_ring_t;
+
+static TIM_HandleTypeDef htim5;
+static icap_ring_t rings[2];
+static icap_stats_t stats;
+static uint32_t tim_clock_hz;
+
+static void icap_cmd_stats(const char *args);
+static void icap_cmd_bench(const char *args);
+
+// DMA가 지금까지 링에 쓴 총 개수
+static uint32_t ring_written(icap_ring_t *r)
+{
+	uint32_t cs = cs_enter(CS_ICAP_RING);
+	uint32_t head, laps;
+
+	head = ICAP_RING_LEN - r->hdma.Instance->NDTR;
+	laps = r->laps;
+	// NDTR은 이미 처음으로 돌아왔는데 TC 인터럽트가 아직 안 불렸으면 그 바퀴도 센다
+	if ((*r->isr & r->tcif) && head < ICAP_RING_LEN / 2) {
+		laps++;
+	}
+	cs_exit(cs);
+
+	return laps * ICAP_RING_LEN + head;
+}
+
+// 읽을 게 있으면 가장 오래된 값을 t에 넣는다. 그새 덮어써졌으면 버린 수를 센다.
+// 한 바퀴 뒤처지면 읽을 칸이 곧 DMA가 쓸 칸이므로, 머리에서 반 바퀴 뒤로 건너뛰어
+// 읽는 동안 덮어써질 여유를 둔다. 그래도 덮어써지면 몇 번만 다시 해 보고 포기한다
+static bool ring_peek(icap_ring_t *r, uint32_t *t)
+{
+	for (int tries = 0; tries < PEEK_TRIES; ++tries)
+	{
+		uint32_t written = ring_written(r);
+
+		if (written - r->read >= ICAP_RING_LEN)
+		{
+			stats.lost += written - PEEK_MARGIN - r->read;
+			r->read = written - PEEK_MARGIN;
+		}
+		if (written == r->read) {
+			return false;
+		}
+
+		*t = r->buf[r->read % ICAP_RING_LEN];
+
+		// 읽는 동안 DMA가 그 칸을 다시 썼으면 믿을 수 없다
+		if (ring_written(r) - r->read <= ICAP_RING_LEN) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void ring_resync(icap_ring_t *r)
+{
+	r->read = ring_written(r);
+}
+
+// 두 링에서 더 이른 엣지 하나를 꺼낸다
+bool icap_read(icap_edge_t *edge)
+{
+	uint32_t t_rise, t_fall;
+	bool has_rise, has_fall;
+	uint32_t sr = htim5.Instance->SR;
+
+	if (sr & (TIM_SR_CC1OF | TIM_SR_CC2OF))
+	{
+		htim5.Instance->SR = ~(sr & (TIM_SR_CC1OF | TIM_SR_CC2OF));
+		stats.overcaptures++;
+	}
+
+	has_rise = ring_peek(&rings[RING_RISE], &t_rise);
+	has_fall = ring_peek(&rings[RING_FALL], &t_fall);
+
+	if (!has_rise && !has_fall) {
+		return false;
+	}
+
+	if (has_rise && (!has_fall || (int32_t)(t_rise - t_fall) < 0))
+	{
+		edge->t = t_rise;
+		edge->rising = 1;
+		rings[RING_RISE].read++;
+	}
+	else
+	{
+		edge->t = t_fall;
+		edge->rising = 0;
+		rings[RING_FALL].read++;
+	}
+	stats.edges++;
+	return true;
+}
+
+uint64_t icap_ticks_to_ns(uint32_t ticks)
+{
+	return (uint64_t)ticks * 1000000000ULL / tim_clock_hz;
+}
+
+void icap_get_stats(icap_stats_t *out)
+{
+	*out = stats;
+}
+
+// DMA1_Stream2/Stream4_IRQHandler에서 호출
+void icap_dma_irq(uint8_t ring)
+{
+	icap_ring_t *r = &rings[ring];
+
+	if (*r->isr & r->tcif)
+	{
+		*r->ifcr = r->tcif;
+		r->laps++;
+	}
+}
+
+static void ring_init(icap_ring_t *r, DMA_Stream_TypeDef *stream, volatile uint32_t *ccr)
+{
+	r->hdma.Instance = stream;
+	r->hdma.Init.Channel = DMA_CHANNEL_6;
+	r->hdma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	r->hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+	r->hdma.Init.MemInc = DMA_MINC_ENABLE;
+	// TIM5는 32비트라 캡처 값도 워드
+	r->hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	r->hdma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	r->hdma.Init.Mode = DMA_CIRCULAR;
+	r->hdma.Init.Priority = DMA_PRIORITY_HIGH;
+	r->hdma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(&r->hdma) != HAL_OK)
+	{
+		Error_Handler();
+	}
+	HAL_DMA_Start(&r->hdma, (uint32_t)ccr, (uint32_t)r->buf, ICAP_RING_LEN);
+	r->hdma.Instance->CR |= DMA_SxCR_TCIE;
+	r->laps = 0;
+	r->read = 0;
+}
+
+void icap_init(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	static bool initialized = false;
+
+	if (initialized) {
+		return;
+	}
+
+	dwt_init();
+	tim_clock_hz = HAL_RCC_GetPCLK1Freq() * 2;
+
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_TIM5_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	GPIO_InitStruct.Pin = GPIO_PIN_1;
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Pull = GPIO_PULLUP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Alternate = GPIO_AF2_TIM5;
+	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+	// 분주 없이 84MHz로 0 ~ 0xFFFFFFFF를 돈다
+	htim5.Instance = TIM5;
+	htim5.Init.Prescaler = 0;
+	htim5.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim5.Init.Period = 0xFFFFFFFF;
+	htim5.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim5.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_Base_Init(&htim5) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	// IC1 = TI2 상승, IC2 = TI2 하강. 필터는 8클럭(약 95ns)이라 두 엣지에 같은 지연만 더한다
+	htim5.Instance->CCMR1 = TIM_CCMR1_CC1S_1 | TIM_CCMR1_IC1F_0 | TIM_CCMR1_IC1F_1
+	                      | TIM_CCMR1_CC2S_0 | TIM_CCMR1_IC2F_0 | TIM_CCMR1_IC2F_1;
+	htim5.Instance->CCER = TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC2P;
+
+	rings[RING_RISE].isr = &DMA1->LISR;
+	rings[RING_RISE].ifcr = &DMA1->LIFCR;
+	rings[RING_RISE].tcif = DMA_LISR_TCIF2;
+	rings[RING_FALL].isr = &DMA1->HISR;
+	rings[RING_FALL].ifcr = &DMA1->HIFCR;
+	rings[RING_FALL].tcif = DMA_HISR_TCIF4;
+	ring_init(&rings[RING_RISE], DMA1_Stream2, &htim5.Instance->CCR1);
+	ring_init(&rings[RING_FALL], DMA1_Stream4, &htim5.Instance->CCR2);
+
+	HAL_NVIC_SetPriority(DMA1_Stream2_IRQn, IRQ_PRIO_CAPTURE, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Stream2_IRQn);
+	HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, IRQ_PRIO_CAPTURE, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+
+	__HAL_TIM_ENABLE_DMA(&htim5, TIM_DMA_CC1 | TIM_DMA_CC2);
+	__HAL_TIM_ENABLE(&htim5);
+
+	console_register("icap", icap_cmd_stats);
+	console_register("icapbench", icap_cmd_bench);
+	initialized = true;
+}
+
+static void icap_cmd_stats(const char *args)
+{
+	console_printf("icap: %lu edges, %lu lost, %lu overcaptures\r\n",
+	               (unsigned long)stats.edges, (unsigned long)stats.lost, (unsigned long)stats.overcaptures);
+}
+
+#define ICAP_BENCH_EDGES 20000
+
+// 테스트 동안 PA1 대신 TIM4 업데이트(TRGO)를 내부 트리거 ITR2로 받아 CH1(TRC)에 캡처한다.
+// 이웃한 캡처 간격이 TIM4 주기와 정확히 같아야 하므로 빠진 엣지는 간격으로 모두 드러난다.
+// TIM4는 port_scan도 쓰므로 15와 같이 돌리지 않는다.
+static void icap_cmd_bench(const char *args)
+{
+	static const uint16_t periods[] = { 840, 336, 168, 84, 56, 42, 28, 21 };
+	uint32_t ccmr1 = htim5.Instance->CCMR1;
+	uint32_t ccer = htim5.Instance->CCER;
+	uint32_t smcr = htim5.Instance->SMCR;
+	uint32_t best = 0;
+
+	__HAL_RCC_TIM4_CLK_ENABLE();
+	TIM4->CR1 = 0;
+	TIM4->PSC = 0;
+	TIM4->CR2 = TIM_CR2_MMS_1;
+
+	htim5.Instance->CCER = 0;
+	htim5.Instance->SMCR = (smcr & ~TIM_SMCR_TS) | TIM_SMCR_TS_1;
+	htim5.Instance->CCMR1 = (ccmr1 & ~(TIM_CCMR1_CC1S | TIM_CCMR1_IC1F)) | TIM_CCMR1_CC1S;
+	htim5.Instance->CCER = TIM_CCER_CC1E;
+
+	for (uint32_t i = 0; i < sizeof(periods) / sizeof(periods[0]); ++i)
+	{
+		uint32_t period = periods[i];
+		uint32_t rate = tim_clock_hz / period;
+		uint32_t got = 0, missing = 0, last = 0;
+		uint32_t lost0 = stats.lost, over0 = stats.overcaptures;
+		uint32_t start;
+		icap_edge_t e;
+
+		TIM4->ARR = period - 1;
+		TIM4->CNT = 0;
+		ring_resync(&rings[RING_RISE]);
+		ring_resync(&rings[RING_FALL]);
+		TIM4->CR1 = TIM_CR1_CEN;
+
+		start = dwt_cycles();
+		while (got < ICAP_BENCH_EDGES && dwt_cycles() - start < SystemCoreClock / 2)
+		{
+			if (!icap_read(&e)) {
+				continue;
+			}
+			if (got > 0 && e.t - last != period) {
+				missing += (e.t - last) / period - 1;
+			}
+			last = e.t;
+			got++;
+		}
+		TIM4->CR1 = 0;
+
+		console_printf("icapbench %7lu edges/s: %lu read, %lu missing (ring %lu, overcapture %lu)\r\n",
+		               (unsigned long)rate, (unsigned long)got, (unsigned long)missing,
+		               (unsigned long)(stats.lost - lost0), (unsigned long)(stats.overcaptures - over0));
+		if (got == ICAP_BENCH_EDGES && missing == 0) {
+			best = rate;
+		}
+	}
+
+	htim5.Instance->CCER = 0;
+	htim5.Instance->CCMR1 = ccmr1;
+	htim5.Instance->SMCR = smcr;
+	htim5.Instance->CCER = ccer;
+	ring_resync(&rings[RING_RISE]);
+	ring_resync(&rings[RING_FALL]);
+
+	console_printf("icapbench: %lu edges/s sustained without loss\r\n", (unsigned long)best);
+}
+
+// B1을 PA1로 이어 두면 누른 시간(Low 구간)과 뗀 시간을 캡처 정밀도로 출력한다
+void icap_run(void)
+{
+	icap_edge_t e;
+	uint32_t last_t = 0;
+	bool have_last = false;
+
+	icap_init();
+
+	while (1)
+	{
+		console_poll();
+
+		while (icap_read(&e))
+		{
+			if (have_last)
+			{
+				uint64_t ns = icap_ticks_to_ns(e.t - last_t);
+
+				// 상승 엣지면 직전까지 Low였다 = 버튼이 눌려 있던 시간
+				console_printf("%s %lu.%03lu us\r\n", e.rising ? "low " : "high",
+				               (unsigned long)(ns / 1000), (unsigned long)(ns % 1000));
+			}
+			last_t = e.t;
+			have_last = true;
+		}
+		__WFI();
+	}
+}
@@ -0,0 +1,280 @@
+// 폴링 / EXTI / EXTI + 지연 처리의 반응 지연 측정 (04_polling, 05_interrupt 비교를 숫자로)
+//
+// TIM10_CH1(PB8) PWM이 약 780us마다 B1(PC13)을 정해진 폭만큼 Low로 끌어내린다.
+// TIM10은 APB2(분주 1)라 CPU와 같은 84MHz로 세므로, LED를 켠 직후
+// (TIM10 CNT - 하강 엣지 CCR)이 곧 버튼 엣지에서 LED 엣지까지의 CPU 사이클이다.
+// 메인 루프는 매 바퀴 work_us만큼 다른 일을 하는 것으로 흉내 낸다 (04의 HAL_Delay 역할).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "main.h"
+#include "14_latency.h"
+#include "dwt.h"
+#include "bitband.h"
+#include "exti.h"
+#include "gpio_fast.h"
+#include "irq_prio.h"
+#include "reg_bench.h"
+#include "uart_console.h"
+
+#define STIM_PERIOD 65536U
+#define LAT_FLAG_DEFERRED 0
+
+static TIM_HandleTypeDef htim10;
+
+static volatile lat_mode_t mode = LAT_IDLE;
+static uint32_t stim_edge;                 // 하강 엣지가 나오는 CNT (= CCR1)
+
+static uint32_t samples[LAT_TRIALS];
+static volatile uint32_t sample_count;
+
+static flagset_t lat_flags;                // LAT_FLAG_DEFERRED: ISR이 남긴 처리할 누름
+static volatile uint32_t deferred_at;      // 그 누름의 엣지 시각 (DWT)
+
+// 하강 엣지 이후 지난 사이클
+static inline uint32_t since_edge(void)
+{
+	return (uint16_t)(htim10.Instance->CNT - stim_edge);
+}
+
+static inline void record(uint32_t cycles)
+{
+	if (sample_count < LAT_TRIALS) {
+		samples[sample_count++] = cycles;
+	}
+}
+
+static inline bool button_low(void)
+{
+	return !gpio_read(B1_GPIO_Port, B1_Pin);
+}
+
+// 측정 중에만 B1 라인을 빌려 쓴다 (PR은 exti_dispatch가 지운다)
+static void latency_exti(uint16_t pin, void *ctx)
+{
+	if (button_low())
+	{
+		if (mode == LAT_EXTI)
+		{
+			gpio_set(LD2_GPIO_Port, LD2_Pin);
+			record(since_edge());
+		}
+		else if (!flag_test(&lat_flags, LAT_FLAG_DEFERRED))
+		{
+			deferred_at = dwt_cycles() - since_edge();
+			flag_raise(&lat_flags, LAT_FLAG_DEFERRED);
+		}
+	}
+	else if (mode == LAT_EXTI)
+	{
+		gpio_clear(LD2_GPIO_Port, LD2_Pin);
+	}
+}
+
+static void stim_init(void)
+{
+	TIM_OC_InitTypeDef sConfigOC = {0};
+	static bool initialized = false;
+
+	if (initialized) {
+		return;
+	}
+
+	__HAL_RCC_TIM10_CLK_ENABLE();
+
+	htim10.Instance = TIM10;
+	htim10.Init.Prescaler = 0;
+	htim10.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim10.Init.Period = STIM_PERIOD - 1;
+	htim10.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim10.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_PWM_Init(&htim10) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	// PWM1: CNT < CCR1 동안 High, 그 뒤 주기 끝까지 Low (= 버튼 누름)
+	sConfigOC.OCMode = TIM_OCMODE_PWM1;
+	sConfigOC.Pulse = STIM_PERIOD / 2;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	if (HAL_TIM_PWM_ConfigChannel(&htim10, &sConfigOC, TIM_CHANNEL_1) != HAL_OK)
+	{
+		Error_Handler();
+	}
+	initialized = true;
+}
+
+// 쉬는 동안 PB8은 입력으로 돌려 실제 버튼이 그대로 동작하게 한다
+static void stim_pin(bool drive)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	GPIO_InitStruct.Pin = LAT_STIM_PIN;
+	GPIO_InitStruct.Mode = drive ? GPIO_MODE_AF_PP : GPIO_MODE_INPUT;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	GPIO_InitStruct.Alternate = GPIO_AF3_TIM10;
+	HAL_GPIO_Init(LAT_STIM_PORT, &GPIO_InitStruct);
+}
+
+static void busy_wait(uint32_t cycles)
+{
+	uint32_t start = dwt_cycles();
+
+	while (dwt_cycles() - start < cycles) {}
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+// 자극 LAT_TRIALS번 동안 한 가지 방식으로 반응하고 분포를 낸다
+void latency_measure(lat_mode_t m, uint32_t work_us, uint32_t pulse_us, lat_result_t *res)
+{
+	uint32_t work = work_us * (SystemCoreClock / 1000000);
+	uint32_t pulse = pulse_us * (SystemCoreClock / 1000000);
+	uint32_t start, window;
+	uint32_t exti_imr = EXTI->IMR;
+	uint32_t exti_rtsr = EXTI->RTSR;
+	exti_slot_t b1_owner = exti_get(B1_Pin);
+	bool led = false;
+
+	if (pulse < 1 || pulse >= STIM_PERIOD) {
+		pulse = STIM_PERIOD / 2;
+	}
+
+	dwt_init();
+	stim_init();
+	stim_edge = STIM_PERIOD - pulse;
+	__HAL_TIM_SET_COMPARE(&htim10, TIM_CHANNEL_1, stim_edge);
+
+	sample_count = 0;
+	flag_clear(&lat_flags, LAT_FLAG_DEFERRED);
+	gpio_clear(LD2_GPIO_Port, LD2_Pin);
+
+	// 폴링 중엔 EXTI를 막고, 나머지는 양쪽 엣지(뗄 때 LED 끄기)를 받는다
+	if (m == LAT_POLL) {
+		bb_clear(&EXTI->IMR, 13);
+	}
+	else {
+		exti_register(B1_Pin, latency_exti, NULL);
+		EXTI->RTSR |= B1_Pin;
+		EXTI->PR = B1_Pin;
+		bb_set(&EXTI->IMR, 13);
+	}
+	mode = m;
+
+	// 카운터를 멈춘 채로 출력(High)부터 내보내고, 시작 시각을 잡은 뒤 돌린다
+	htim10.Instance->CNT = 0;
+	htim10.Instance->CCER |= TIM_CCER_CC1E;
+	stim_pin(true);
+	start = dwt_cycles();
+	__HAL_TIM_ENABLE(&htim10);
+	// 마지막 엣지 뒤로 거의 한 주기를 처리 시간으로 주고, 다음 엣지 전에 끝낸다
+	window = LAT_TRIALS * STIM_PERIOD + stim_edge - 1;
+
+	while (dwt_cycles() - start < window)
+	{
+		switch (m)
+		{
+		case LAT_POLL:
+			if (button_low())
+			{
+				if (!led)
+				{
+					gpio_set(LD2_GPIO_Port, LD2_Pin);
+					record(since_edge());
+					led = true;
+				}
+			}
+			else if (led)
+			{
+				gpio_clear(LD2_GPIO_Port, LD2_Pin);
+				led = false;
+			}
+			break;
+
+		case LAT_DEFER:
+			if (flag_take(&lat_flags, LAT_FLAG_DEFERRED))
+			{
+				gpio_set(LD2_GPIO_Port, LD2_Pin);
+				record(dwt_cycles() - deferred_at);
+				led = true;
+			}
+			else if (led && !button_low())
+			{
+				gpio_clear(LD2_GPIO_Port, LD2_Pin);
+				led = false;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		busy_wait(work);
+	}
+
+	mode = LAT_IDLE;
+	stim_pin(false);
+	HAL_TIM_PWM_Stop(&htim10, TIM_CHANNEL_1);
+	EXTI->RTSR = exti_rtsr;
+	EXTI->PR = B1_Pin;
+	EXTI->IMR = exti_imr;
+	exti_register(B1_Pin, b1_owner.handler, b1_owner.ctx);
+	gpio_clear(LD2_GPIO_Port, LD2_Pin);
+
+	res->count = sample_count;
+	res->missed = LAT_TRIALS - sample_count;
+	if (sample_count == 0)
+	{
+		res->min = res->median = res->p99 = res->max = 0;
+		return;
+	}
+
+	qsort(samples, sample_count, sizeof(samples[0]), cmp_u32);
+	res->min = samples[0];
+	res->median = samples[sample_count / 2];
+	res->p99 = samples[(sample_count * 99) / 100];
+	res->max = samples[sample_count - 1];
+}
+
+// lat [work_us] [pulse_us]
+static void latency_cmd(const char *args)
+{
+	static const char *const name[] = { "", "poll ", "exti ", "defer" };
+	unsigned work_us = 100, pulse_us = 50;
+	lat_result_t r;
+
+	sscanf(args, "%u %u", &work_us, &pulse_us);
+	console_printf("lat: work %u us per loop, press %u us, %u presses (PB8 -> PC13)\r\n",
+	               work_us, pulse_us, LAT_TRIALS);
+
+	for (int m = LAT_POLL; m <= LAT_DEFER; ++m)
+	{
+		latency_measure((lat_mode_t)m, work_us, pulse_us, &r);
+		console_printf("lat %s: min %lu, median %lu, p99 %lu, max %lu cycles, %lu missed\r\n",
+		               name[m], (unsigned long)r.min, (unsigned long)r.median, (unsigned long)r.p99,
+		               (unsigned long)r.max, (unsigned long)r.missed);
+	}
+}
+
+void latency_run(void)
+{
+	console_register("lat", latency_cmd);
+	reg_bench_init();
+	exti_bench_init();
+	irq_prio_bench_init();
+	latency_cmd("");
+
+	while (1)
+	{
+		console_poll();
+		__WFI();
+	}
+}
@@ -0,0 +1,30 @@
+// 포트 스캐너로 입력 받기 (04 폴링, 05 인터럽트와 비교)
+//
+// B1(PC13)을 port_scan에 구독해서 바뀔 때마다 LD2에 그대로 옮긴다.
+// 메인 루프는 콘솔만 본다. "scan"으로 스캔 한 번의 사이클과 CPU 점유율,
+// "scanbench"로 A/B/C 48핀을 다 볼 때의 비용을 핀마다 읽는 방식과 비교한다.
+
+#include <stdbool.h>
+#include "main.h"
+#include "15_inputs.h"
+#include "gpio_fast.h"
+#include "port_scan.h"
+#include "uart_console.h"
+
+// TIM4 ISR에서 불린다. B1은 누르면 Low
+static void on_b1(GPIO_TypeDef *port, uint16_t pin, bool level, void *ctx)
+{
+	gpio_write(LD2_GPIO_Port, LD2_Pin, !level);
+}
+
+void inputs_run(void)
+{
+	port_scan_init();
+	port_scan_subscribe(B1_GPIO_Port, B1_Pin, on_b1, NULL);
+
+	while (1)
+	{
+		console_poll();
+		__WFI();
+	}
+}
@@ -0,0 +1,245 @@
+// 주변 밝기에 따라 TM1637 밝기와 램프 듀티를 맞추는 조도 서비스
+//
+// ADC1을 연속 변환 모드로 돌리고 DMA2 Stream0(채널 0)이 결과를 순환 버퍼에 계속 덮어쓴다.
+// 샘플마다 인터럽트는 없고, AMBIENT_PERIOD_MS마다 TIM2 작업이 버퍼 평균을 읽어
+// 시간 평균(EMA)을 내고 히스테리시스를 둔 단계로 바꾼다.
+// ADC HAL 모듈은 켜져 있지 않아서 ADC는 레지스터로 직접 설정한다.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "main.h"
+#include "00_timer2.h"
+#include "ambient.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include "uart_console.h"
+
+#define AMBIENT_SAMPLES 64
+
+static DMA_HandleTypeDef hdma_adc1;
+static volatile uint16_t adc_buf[AMBIENT_SAMPLES];
+
+static ambient_cb_t ambient_cb = NULL;
+static ambient_status_t status;
+static bool primed = false;        // 첫 평균을 받았나
+// 신호등이 켜져 있는 내내 쌓이므로 64비트 (32비트 사이클은 100ms 작업으로 약 일주일이면 넘친다).
+// TIM2 작업에서 쓰고 메인 루프가 읽으므로 CS_AMBIENT_LOAD 안에서 읽는다
+static uint64_t busy_cycles = 0;
+static uint64_t elapsed_ms = 0;    // 시작부터 마지막 작업까지 (get_tim2_ms는 49일이면 한 바퀴)
+static uint32_t last_ms = 0;
+
+// 단계별 램프 밝기 (BAM 0~255)
+static const uint8_t lamp_level[AMBIENT_LEVELS] = { 24, 40, 64, 96, 128, 176, 224, 255 };
+
+// 경계를 AMBIENT_HYST만큼 넘어야 단계가 바뀐다
+uint8_t ambient_level_step(uint8_t level, uint16_t light)
+{
+	while (level < AMBIENT_LEVELS - 1 && light >= (level + 1) * AMBIENT_BAND + AMBIENT_HYST) {
+		level++;
+	}
+	while (level > 0 && light + AMBIENT_HYST < level * AMBIENT_BAND) {
+		level--;
+	}
+	return level;
+}
+
+// 1/8 지수 이동 평균 (100ms마다면 시정수 약 0.8초)
+uint16_t ambient_filter(uint16_t filtered, uint16_t sample)
+{
+	return (uint16_t)(filtered + ((int32_t)sample - filtered) / 8);
+}
+
+uint8_t ambient_lamp_level(void)
+{
+	return lamp_level[status.level];
+}
+
+static void ambient_job(void)
+{
+	uint32_t t0 = dwt_cycles();
+	uint32_t now = get_tim2_ms();
+	uint32_t sum = 0;
+
+	tim2_schedule(now + AMBIENT_PERIOD_MS, ambient_job);
+	elapsed_ms += now - last_ms;
+	last_ms = now;
+
+	for (int i = 0; i < AMBIENT_SAMPLES; ++i) {
+		sum += adc_buf[i];
+	}
+	status.raw_avg = (uint16_t)(sum / AMBIENT_SAMPLES);
+	// 첫 평균은 그대로 써서 켜자마자 맞는 단계로 간다
+	status.filtered = primed ? ambient_filter(status.filtered, status.raw_avg) : status.raw_avg;
+	primed = true;
+
+	uint8_t level = ambient_level_step(status.level, status.filtered);
+
+	if (level != status.level)
+	{
+		status.level = level;
+		status.changes++;
+		if (ambient_cb != NULL) {
+			ambient_cb(level);
+		}
+	}
+
+	busy_cycles += dwt_cycles() - t0;
+}
+
+static void adc_init(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_ADC1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	GPIO_InitStruct.Pin = GPIO_PIN_0;
+	GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+	hdma_adc1.Instance = DMA2_Stream0;
+	hdma_adc1.Init.Channel = DMA_CHANNEL_0;
+	hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	hdma_adc1.Init.Mode = DMA_CIRCULAR;
+	hdma_adc1.Init.Priority = DMA_PRIORITY_LOW;
+	hdma_adc1.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(&hdma_adc1) != HAL_OK)
+	{
+		Error_Handler();
+	}
+	HAL_DMA_Start(&hdma_adc1, (uint32_t)&ADC1->DR, (uint32_t)adc_buf, AMBIENT_SAMPLES);
+
+	// ADCCLK = PCLK2 / 4 = 21MHz, 480 사이클 샘플링 -> 약 42.7kSPS
+	ADC->CCR = (ADC->CCR & ~ADC_CCR_ADCPRE) | ADC_CCR_ADCPRE_0;
+	ADC1->SMPR2 = ADC_SMPR2_SMP0;
+	ADC1->SQR1 = 0;                          // 변환 1개
+	ADC1->SQR3 = 0;                          // IN0
+	ADC1->CR1 = 0;                           // 12비트, 인터럽트 없음
+	ADC1->CR2 = ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_DDS | ADC_CR2_ADON;
+
+	// ADON 후 안정화 (tSTAB 최대 3us)
+	for (volatile int i = 0; i < 300; ++i) {}
+	ADC1->CR2 |= ADC_CR2_SWSTART;
+}
+
+void ambient_get_status(ambient_status_t *out)
+{
+	uint32_t cs = cs_enter(CS_AMBIENT_LOAD);
+	// DWT 카운터는 51초마다 한 바퀴 돌아서 경과 시간은 ms 틱으로 잰다
+	uint64_t elapsed = (elapsed_ms + (get_tim2_ms() - last_ms)) * (SystemCoreClock / 1000);
+
+	status.load_ppm = (uint32_t)(busy_cycles * 1000000 / (elapsed ? elapsed : 1));
+	*out = status;
+	cs_exit(cs);
+}
+
+static void ambient_cmd_status(const char *args)
+{
+	ambient_status_t st;
+
+	ambient_get_status(&st);
+	console_printf("light: raw %u, filtered %u, level %u (lamp %u), %lu changes, load %lu ppm\r\n",
+	               st.raw_avg, st.filtered, st.level, ambient_lamp_level(),
+	               (unsigned long)st.changes, (unsigned long)st.load_ppm);
+}
+
+// 합성 조도 곡선 (100ms 간격 샘플)
+typedef enum {
+	CURVE_SUNRISE,     // 60초 동안 0 -> 4095, 노이즈 +-60
+	CURVE_THRESHOLD,   // 경계값 근처에 머무름, 노이즈 +-80
+	CURVE_CLOUDS,      // 5초마다 밝기가 크게 바뀜
+	CURVE_SLOW_SINE,   // 20초 주기, 진폭 300
+	CURVE_COUNT
+} light_curve_t;
+
+static const char *const curve_name[CURVE_COUNT] = { "sunrise", "threshold", "clouds", "sine" };
+
+#define LIGHTTEST_SAMPLES 600
+// 반대 방향 변화가 이보다 빨리 오면 진동으로 본다 (1초)
+#define LIGHTTEST_MIN_HOLD 10
+
+static int32_t curve_sample(light_curve_t curve, int i, uint32_t *rng)
+{
+	*rng ^= *rng << 13;
+	*rng ^= *rng >> 17;
+	*rng ^= *rng << 5;
+	int32_t noise = (int32_t)(*rng % 161) - 80;
+
+	switch (curve)
+	{
+	case CURVE_SUNRISE:
+		return i * 4095 / LIGHTTEST_SAMPLES + noise * 60 / 80;
+	case CURVE_THRESHOLD:
+		return 3 * AMBIENT_BAND + noise;
+	case CURVE_CLOUDS:
+		return ((i / 50) & 1) ? 3500 + noise : 900 + noise;
+	default:
+	{
+		// 삼각파로 근사한 사인 (200샘플 주기)
+		int32_t phase = i % 200;
+		int32_t tri = (phase < 100) ? phase : 200 - phase;
+		return 2048 - 300 + tri * 6 + noise;
+	}
+	}
+}
+
+// 단계가 올라갔다가 1초 안에 다시 내려가는(또는 그 반대) 경우를 센다
+static void ambient_cmd_test(const char *args)
+{
+	uint32_t rng = 0x2468ACE;
+	int failed = 0;
+
+	for (int c = 0; c < CURVE_COUNT; ++c)
+	{
+		uint16_t filtered = 0;
+		uint8_t level = 0;
+		int last_dir = 0, last_change = -LIGHTTEST_MIN_HOLD;
+		uint32_t changes = 0, reversals = 0;
+
+		for (int i = 0; i < LIGHTTEST_SAMPLES; ++i)
+		{
+			int32_t s = curve_sample((light_curve_t)c, i, &rng);
+
+			s = (s < 0) ? 0 : (s > 4095) ? 4095 : s;
+			filtered = (i == 0) ? (uint16_t)s : ambient_filter(filtered, (uint16_t)s);
+
+			uint8_t next = ambient_level_step(level, filtered);
+			if (next == level) {
+				continue;
+			}
+
+			int dir = (next > level) ? 1 : -1;
+			if (dir == -last_dir && i - last_change < LIGHTTEST_MIN_HOLD) {
+				reversals++;
+			}
+			last_dir = dir;
+			last_change = i;
+			level = next;
+			changes++;
+		}
+
+		console_printf("lighttest %-9s: %lu changes, %lu reversals < 1s %s\r\n", curve_name[c],
+		               (unsigned long)changes, (unsigned long)reversals, reversals ? "FAIL" : "ok");
+		failed |= (reversals != 0);
+	}
+	console_printf("lighttest: %s\r\n", failed ? "FAIL" : "PASS");
+}
+
+// cb는 단계가 바뀔 때 TIM2 작업 안에서 불린다
+void ambient_init(ambient_cb_t cb)
+{
+	dwt_init();
+	adc_init();
+	ambient_cb = cb;
+	last_ms = get_tim2_ms();
+
+	console_register("light", ambient_cmd_status);
+	console_register("lighttest", ambient_cmd_test);
+	tim2_schedule(get_tim2_ms() + AMBIENT_PERIOD_MS, ambient_job);
+}
@@ -0,0 +1,178 @@
+// 비트 앵글 변조(BAM)로 타이머 채널 없는 GPIO 핀 밝기 조절
+//
+// 밝기의 비트 k를 2^k 단위 시간 동안 내보낸다. 평면마다 BSRR 워드 하나라서
+// 한 포트의 16핀을 8비트로 조절하는 데 워드 8개면 된다.
+// TIM1 업데이트마다 DMA2 Stream5(TIM1_UP, 채널 6)가 다음 평면을 BSRR에 쓰고,
+// 평면 시작 직후 CC1 요청으로 DMA2 Stream1(TIM1_CH1, 채널 6)이 그다음 평면 길이를 ARR
+// 프리로드에 쓴다. 평면이 바뀔 때 인터럽트는 없다.
+// (11_blink_hw와 같은 TIM1/DMA2 스트림을 쓰므로 둘은 함께 쓸 수 없다)
+
+#include <string.h>
+#include "main.h"
+#include "bam.h"
+#include "dwt.h"
+#include "uart_console.h"
+
+// 가장 짧은 평면 = 336 / 84MHz = 4us, 한 프레임 255 x 4us = 1.02ms (약 980Hz)
+#define BAM_UNIT 336
+
+static TIM_HandleTypeDef htim1;
+static DMA_HandleTypeDef hdma_bam_bsrr;
+static DMA_HandleTypeDef hdma_bam_arr;
+
+static bam_frame_t frame;
+// arr_next[k] = 평면 k 동안 프리로드에 써 둘 평면 k+1의 ARR
+static uint32_t arr_next[BAM_PLANES];
+
+// 관리하는 핀 전부를 현재 밝기로 다시 계산
+void bam_frame_build(bam_frame_t *f, uint16_t pins)
+{
+	f->pins = pins;
+
+	for (int k = 0; k < BAM_PLANES; ++k)
+	{
+		uint32_t word = 0;
+
+		for (int pin = 0; pin < 16; ++pin)
+		{
+			if (!(pins & (1U << pin))) {
+				continue;
+			}
+			word |= (f->level[pin] & (1U << k)) ? (1U << pin) : (1U << (pin + 16));
+		}
+		f->plane[k] = word;
+	}
+}
+
+// 바뀐 비트가 있는 평면만 해당 핀의 set/reset 비트를 뒤집는다.
+// 워드 하나씩 쓰므로 DMA가 읽는 도중에 고쳐도 한 프레임만 섞인다.
+void bam_frame_set(bam_frame_t *f, uint16_t pins, uint8_t level)
+{
+	pins &= f->pins;
+
+	while (pins)
+	{
+		int pin = __builtin_ctz(pins);
+		uint8_t diff = f->level[pin] ^ level;
+
+		pins &= pins - 1;
+		f->level[pin] = level;
+
+		while (diff)
+		{
+			int k = __builtin_ctz(diff);
+
+			diff &= diff - 1;
+			f->plane[k] ^= (1U << pin) | (1U << (pin + 16));
+		}
+	}
+}
+
+static void dma_init(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *stream)
+{
+	hdma->Instance = stream;
+	hdma->Init.Channel = DMA_CHANNEL_6;
+	hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma->Init.MemInc = DMA_MINC_ENABLE;
+	hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	hdma->Init.Mode = DMA_CIRCULAR;
+	hdma->Init.Priority = DMA_PRIORITY_VERY_HIGH;
+	hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(hdma) != HAL_OK)
+	{
+		Error_Handler();
+	}
+}
+
+static void bam_cmd_bench(const char *args)
+{
+	uint32_t full, incr;
+
+	bam_bench(&full, &incr);
+	console_printf("bam: full rebuild %lu cycles, one pin change %lu cycles\r\n",
+	               (unsigned long)full, (unsigned long)incr);
+}
+
+// pins는 출력 모드로 이미 설정되어 있어야 한다. 처음엔 모두 꺼짐
+void bam_init(GPIO_TypeDef *port, uint16_t pins)
+{
+	TIM_OC_InitTypeDef sConfigOC = {0};
+
+	dwt_init();
+	memset(&frame, 0, sizeof(frame));
+	bam_frame_build(&frame, pins);
+
+	for (int k = 0; k < BAM_PLANES; ++k) {
+		arr_next[k] = (BAM_UNIT << ((k + 1) % BAM_PLANES)) - 1;
+	}
+
+	__HAL_RCC_TIM1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	htim1.Instance = TIM1;
+	htim1.Init.Prescaler = 0;
+	htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim1.Init.Period = BAM_UNIT - 1;
+	htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim1.Init.RepetitionCounter = 0;
+	// ARR 프리로드: DMA가 평면 중간에 쓴 값은 다음 업데이트부터 적용
+	htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+	if (HAL_TIM_Base_Init(&htim1) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	// CNT가 1일 때 CC1 -> 평면이 시작되자마자 다음 길이를 쓴다
+	sConfigOC.OCMode = TIM_OCMODE_TIMING;
+	sConfigOC.Pulse = 1;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+	HAL_TIM_OC_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_1);
+
+	dma_init(&hdma_bam_bsrr, DMA2_Stream5);
+	dma_init(&hdma_bam_arr, DMA2_Stream1);
+	HAL_DMA_Start(&hdma_bam_bsrr, (uint32_t)frame.plane, (uint32_t)&port->BSRR, BAM_PLANES);
+	HAL_DMA_Start(&hdma_bam_arr, (uint32_t)arr_next, (uint32_t)&htim1.Instance->ARR, BAM_PLANES);
+	__HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE | TIM_DMA_CC1);
+
+	// UG: 평면 0 길이를 섀도에 올리고 평면 0을 BSRR로 보낸 뒤 시작
+	htim1.Instance->EGR = TIM_EGR_UG;
+	__HAL_TIM_ENABLE(&htim1);
+
+	console_register("bambench", bam_cmd_bench);
+}
+
+void bam_set(uint16_t pins, uint8_t level)
+{
+	bam_frame_set(&frame, pins, level);
+}
+
+#define BAM_BENCH_CHANGES 256
+
+// 16핀 전체 재계산과 핀 하나 밝기 변경(증분)의 사이클. 출력 중인 프레임은 건드리지 않는다
+void bam_bench(uint32_t *full_cycles, uint32_t *incr_cycles)
+{
+	bam_frame_t scratch;
+	uint32_t start, total = 0;
+
+	for (int pin = 0; pin < 16; ++pin) {
+		scratch.level[pin] = (uint8_t)(pin * 17);
+	}
+
+	start = dwt_cycles();
+	bam_frame_build(&scratch, 0xFFFF);
+	*full_cycles = dwt_cycles() - start;
+
+	for (uint32_t i = 0; i < BAM_BENCH_CHANGES; ++i)
+	{
+		uint16_t pin = (uint16_t)(1U << (i % 16));
+		uint8_t level = (uint8_t)(i * 37);
+
+		start = dwt_cycles();
+		bam_frame_set(&scratch, pin, level);
+		total += dwt_cycles() - start;
+	}
+	*incr_cycles = total / BAM_BENCH_CHANGES;
+}
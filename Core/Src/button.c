@@ -0,0 +1,262 @@
+// 여러 버튼을 TIM2 1ms 틱에서 함께 샘플링하는 입력 모듈
+//
+// 쓰는 포트마다 IDR을 한 번만 읽어 모든 버튼의 현재 레벨을 32비트 마스크로 모은 뒤,
+// 레벨이 디바운스 상태와 다르거나 적분기가 중간에 있는 버튼만 골라 적분기를 움직인다.
+// 적분기가 0 또는 BUTTON_DEBOUNCE_MS에 닿을 때만 상태가 바뀐다.
+// 이벤트는 TIM2 ISR(쓰기 하나)과 메인 루프(읽기 하나) 사이의 락 없는 큐로 넘긴다.
+
+#include <stdio.h>
+#include "main.h"
+#include "00_timer2.h"
+#include "button.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include "uart_console.h"
+
+#define BUTTON_PORTS 5
+#define QUEUE_MASK (BUTTON_QUEUE_LEN - 1)
+
+typedef struct {
+	GPIO_TypeDef *port;
+	uint16_t mask;          // 이 포트에서 쓰는 핀
+	uint16_t invert;        // active low 핀
+	uint8_t id[16];         // 핀 번호 -> 버튼 id
+} button_port_t;
+
+static button_port_t ports[BUTTON_PORTS];
+static uint8_t port_count = 0;
+static uint8_t button_count = 0;
+
+static uint8_t integ[BUTTON_MAX];
+static volatile uint32_t stable = 0;   // 디바운스된 눌림 (비트 = id)
+static uint32_t unsettled = 0;         // 적분기가 0도 상한도 아닌 버튼
+static uint32_t long_sent = 0;         // 이번 누름에서 LONG을 보냄
+static uint32_t click_armed = 0;       // 짧게 눌렀다 뗐고 더블 클릭을 기다림
+static uint32_t doubled = 0;           // 이번 누름이 더블 클릭의 두 번째
+static uint32_t press_ms[BUTTON_MAX];
+static uint32_t release_ms[BUTTON_MAX];
+static uint32_t repeat_ms[BUTTON_MAX];
+
+static button_event_t queue[BUTTON_QUEUE_LEN];
+static volatile uint32_t q_head = 0;   // TIM2 ISR만 쓴다
+static volatile uint32_t q_tail = 0;   // 메인 루프만 쓴다
+static uint32_t dropped = 0;
+
+static uint32_t tick_cycles = 0;
+static uint32_t tick_cycles_max = 0;
+
+static void push(uint8_t id, button_ev_type_t type, uint32_t now)
+{
+	uint32_t head = q_head;
+
+	if (head - q_tail >= BUTTON_QUEUE_LEN)
+	{
+		dropped++;
+		return;
+	}
+	queue[head & QUEUE_MASK].id = id;
+	queue[head & QUEUE_MASK].type = (uint8_t)type;
+	queue[head & QUEUE_MASK].ms = now;
+	// 내용을 다 쓴 뒤에 head를 넘긴다
+	__DMB();
+	q_head = head + 1;
+}
+
+bool button_get(button_event_t *ev)
+{
+	uint32_t tail = q_tail;
+
+	if (tail == q_head) {
+		return false;
+	}
+	*ev = queue[tail & QUEUE_MASK];
+	__DMB();
+	q_tail = tail + 1;
+	return true;
+}
+
+bool button_is_pressed(uint8_t id)
+{
+	return (stable >> id) & 1U;
+}
+
+static void on_press(uint8_t id, uint32_t bit, uint32_t now)
+{
+	push(id, BUTTON_PRESS, now);
+	long_sent &= ~bit;
+	press_ms[id] = now;
+
+	if ((click_armed & bit) && now - release_ms[id] <= BUTTON_DOUBLE_MS)
+	{
+		push(id, BUTTON_DOUBLE, now);
+		doubled |= bit;
+	}
+	click_armed &= ~bit;
+}
+
+static void on_release(uint8_t id, uint32_t bit, uint32_t now)
+{
+	push(id, BUTTON_RELEASE, now);
+
+	// 길게 누른 것과 더블 클릭의 두 번째는 다음 더블 클릭의 첫 번째가 되지 않는다
+	if (!(long_sent & bit) && !(doubled & bit))
+	{
+		click_armed |= bit;
+		release_ms[id] = now;
+	}
+	doubled &= ~bit;
+}
+
+static void button_tick(void)
+{
+	uint32_t start = dwt_cycles();
+	uint32_t now = get_tim2_ms();
+	uint32_t raw = 0;
+	uint32_t busy, held;
+
+	// 포트당 IDR 한 번
+	for (int p = 0; p < port_count; ++p)
+	{
+		uint32_t bits = (ports[p].port->IDR ^ ports[p].invert) & ports[p].mask;
+
+		while (bits)
+		{
+			raw |= 1U << ports[p].id[__builtin_ctz(bits)];
+			bits &= bits - 1;
+		}
+	}
+
+	busy = (raw ^ stable) | unsettled;
+	while (busy)
+	{
+		uint8_t id = (uint8_t)__builtin_ctz(busy);
+		uint32_t bit = 1U << id;
+
+		busy &= busy - 1;
+
+		if (raw & bit)
+		{
+			if (integ[id] < BUTTON_DEBOUNCE_MS) {
+				integ[id]++;
+			}
+		}
+		else if (integ[id] > 0) {
+			integ[id]--;
+		}
+
+		if (integ[id] == BUTTON_DEBOUNCE_MS)
+		{
+			unsettled &= ~bit;
+			if (!(stable & bit))
+			{
+				stable |= bit;
+				on_press(id, bit, now);
+			}
+		}
+		else if (integ[id] == 0)
+		{
+			unsettled &= ~bit;
+			if (stable & bit)
+			{
+				stable &= ~bit;
+				on_release(id, bit, now);
+			}
+		}
+		else {
+			unsettled |= bit;
+		}
+	}
+
+	// 누르고 있는 버튼의 LONG / REPEAT
+	held = stable;
+	while (held)
+	{
+		uint8_t id = (uint8_t)__builtin_ctz(held);
+		uint32_t bit = 1U << id;
+
+		held &= held - 1;
+
+		if (!(long_sent & bit))
+		{
+			if (now - press_ms[id] >= BUTTON_LONG_MS)
+			{
+				push(id, BUTTON_LONG, now);
+				long_sent |= bit;
+				repeat_ms[id] = now + BUTTON_REPEAT_MS;
+			}
+		}
+		else if ((int32_t)(now - repeat_ms[id]) >= 0)
+		{
+			push(id, BUTTON_REPEAT, now);
+			repeat_ms[id] += BUTTON_REPEAT_MS;
+		}
+	}
+
+	tick_cycles = dwt_cycles() - start;
+	if (tick_cycles > tick_cycles_max) {
+		tick_cycles_max = tick_cycles;
+	}
+}
+
+// 핀은 입력으로 이미 설정되어 있어야 한다. 돌려주는 id로 이벤트를 구분한다
+int button_add(GPIO_TypeDef *port, uint16_t pin, bool active_low)
+{
+	uint32_t cs;
+	int p, id;
+
+	if (button_count >= BUTTON_MAX || pin == 0 || (pin & (pin - 1)) != 0) {
+		return -1;
+	}
+
+	for (p = 0; p < port_count; ++p)
+	{
+		if (ports[p].port == port) {
+			break;
+		}
+	}
+	if (p == port_count)
+	{
+		if (port_count >= BUTTON_PORTS) {
+			return -1;
+		}
+		ports[p].port = port;
+		port_count++;
+	}
+	if (ports[p].mask & pin) {
+		return -1;
+	}
+
+	id = button_count;
+	// 샘플링 중에 반만 등록된 버튼을 보지 않게 한다
+	cs = cs_enter(CS_BUTTON_TABLE);
+	ports[p].id[__builtin_ctz(pin)] = (uint8_t)id;
+	if (active_low) {
+		ports[p].invert |= pin;
+	}
+	ports[p].mask |= pin;
+	button_count++;
+	cs_exit(cs);
+
+	return id;
+}
+
+static void button_cmd_status(const char *args)
+{
+	console_printf("btn: %u buttons on %u ports, pressed 0x%08lx, %lu dropped, tick %lu cycles (max %lu)\r\n",
+	               button_count, port_count, (unsigned long)stable, (unsigned long)dropped,
+	               (unsigned long)tick_cycles, (unsigned long)tick_cycles_max);
+}
+
+void button_init(void)
+{
+	static bool initialized = false;
+
+	if (initialized) {
+		return;
+	}
+
+	dwt_init();
+	tim2_register_callback(button_tick);
+	console_register("btn", button_cmd_status);
+	initialized = true;
+}
@@ -0,0 +1,343 @@
+// EXTI 라인별 핸들러 표
+//
+// HAL_GPIO_EXTI_Callback은 약한 전역 심볼 하나라 한 모듈만 EXTI를 쓸 수 있었다.
+// 여기서는 GPIO 라인 0~15마다 핸들러와 ctx를 두고, IRQ 핸들러가 자기 벡터의 라인 마스크로
+// exti_dispatch()를 부른다. PR에서 걸린 비트만 CLZ로 하나씩 꺼내므로
+// 걸린 라인 수만큼만 돈다. 핀 모드/엣지 설정은 지금처럼 HAL_GPIO_Init으로 한다.
+//
+// exti_stamp_enable로 켠 라인은 ISR에 들어오자마자 읽은 DWT 사이클 값을 라인별 링에 넣는다.
+// TIM2는 1ms마다 CNT가 처음으로 돌아가서 32비트 시각으로 쓸 수 없다.
+// 링은 ISR만 head를, 꺼내는 쪽만 tail을 바꾸는 단일 생산자/소비자라 락이 없다.
+// 다음 ISR 전에 같은 라인에 엣지가 두 번 오면 PR 비트 하나로 합쳐져 시각도 하나만 남는다.
+
+#include <stdio.h>
+#include "main.h"
+#include "bitband.h"
+#include "dwt.h"
+#include "exti.h"
+#include "irq_prio.h"
+#include "uart_console.h"
+
+#define EXTI_GPIO_LINES 16
+#define STAMP_MASK (EXTI_STAMP_LEN - 1)
+
+_Static_assert((EXTI_STAMP_LEN & STAMP_MASK) == 0, "EXTI_STAMP_LEN must be a power of 2");
+
+typedef struct {
+	volatile uint32_t head;   // ISR만 쓴다
+	volatile uint32_t tail;   // 꺼내는 쪽만 쓴다
+	uint32_t buf[EXTI_STAMP_LEN];
+	uint32_t dropped, overflows;
+	bool full;
+} stamp_ring_t;
+
+static exti_slot_t slots[EXTI_GPIO_LINES];
+static stamp_ring_t rings[EXTI_GPIO_LINES];
+static volatile uint32_t stamp_lines;     // 시각을 남기는 라인 마스크
+
+static IRQn_Type line_irq(uint32_t line)
+{
+	static const IRQn_Type low[5] = { EXTI0_IRQn, EXTI1_IRQn, EXTI2_IRQn, EXTI3_IRQn, EXTI4_IRQn };
+
+	if (line < 5) {
+		return low[line];
+	}
+	return (line < 10) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+}
+
+// handler가 NULL이면 해제. 같은 벡터를 쓰는 다른 라인은 영향받지 않는다
+void exti_register(uint16_t pin, exti_handler_t handler, void *ctx)
+{
+	uint32_t line = (uint32_t)__builtin_ctz(pin);
+	uint32_t cs = cs_enter(CS_EXTI_SLOTS);
+
+	slots[line].handler = handler;
+	slots[line].ctx = ctx;
+	cs_exit(cs);
+
+	if (handler != NULL)
+	{
+		HAL_NVIC_SetPriority(line_irq(line), IRQ_PRIO_EXTI, 0);
+		HAL_NVIC_EnableIRQ(line_irq(line));
+	}
+}
+
+// 잠시 라인을 빌려 쓰는 모듈이 원래 핸들러를 돌려놓을 때 쓴다
+exti_slot_t exti_get(uint16_t pin)
+{
+	return slots[__builtin_ctz(pin)];
+}
+
+static void stamp_push(uint32_t lines, uint32_t now)
+{
+	while (lines)
+	{
+		uint32_t line = 31U - __CLZ(lines);
+		stamp_ring_t *r = &rings[line];
+		uint32_t head = r->head;
+
+		lines &= ~(1U << line);
+		if (head - r->tail >= EXTI_STAMP_LEN)
+		{
+			r->dropped++;
+			if (!r->full) {
+				r->overflows++;
+			}
+			r->full = true;
+			continue;
+		}
+		r->buf[head & STAMP_MASK] = now;
+		r->full = false;
+		// 내용을 다 쓴 뒤에 head를 넘긴다
+		__DMB();
+		r->head = head + 1;
+	}
+}
+
+// EXTIx_IRQHandler에서 그 벡터의 라인 마스크로 호출
+void exti_dispatch(uint32_t lines)
+{
+	uint32_t now = DWT->CYCCNT;
+	uint32_t pending = EXTI->PR & lines;
+
+	// 핸들러 도중 같은 라인에 다시 엣지가 오면 한 번 더 불리도록 먼저 지운다
+	EXTI->PR = pending;
+
+	// 핸들러가 자기 엣지 시각을 바로 꺼내 볼 수 있게 먼저 넣는다
+	if (pending & stamp_lines) {
+		stamp_push(pending & stamp_lines, now);
+	}
+
+	while (pending)
+	{
+		uint32_t line = 31U - __CLZ(pending);
+		exti_slot_t *slot = &slots[line];
+
+		pending &= ~(1U << line);
+		if (slot->handler != NULL) {
+			slot->handler((uint16_t)(1U << line), slot->ctx);
+		}
+	}
+}
+
+// 켜거나 끌 때 그 라인의 링과 카운터를 비운다. DWT가 꺼져 있으면 켠다(돌고 있으면 그대로 둔다)
+void exti_stamp_enable(uint16_t pin, bool on)
+{
+	uint32_t line = (uint32_t)__builtin_ctz(pin);
+	stamp_ring_t *r = &rings[line];
+	uint32_t cs;
+
+	if (on && !(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+		dwt_init();
+	}
+
+	cs = cs_enter(CS_EXTI_SLOTS);
+	r->head = 0;
+	r->tail = 0;
+	r->dropped = 0;
+	r->overflows = 0;
+	r->full = false;
+	if (on) {
+		stamp_lines |= pin;
+	} else {
+		stamp_lines &= ~(uint32_t)pin;
+	}
+	cs_exit(cs);
+}
+
+// 가장 오래된 엣지 시각(DWT 사이클) 하나를 꺼낸다. 두 시각의 차가 곧 엣지 간격이다
+bool exti_stamp_get(uint16_t pin, uint32_t *cycles)
+{
+	stamp_ring_t *r = &rings[__builtin_ctz(pin)];
+	uint32_t tail = r->tail;
+
+	if (tail == r->head) {
+		return false;
+	}
+	*cycles = r->buf[tail & STAMP_MASK];
+	__DMB();
+	r->tail = tail + 1;
+	return true;
+}
+
+void exti_stamp_stats(uint16_t pin, exti_stamp_stats_t *stats)
+{
+	stamp_ring_t *r = &rings[__builtin_ctz(pin)];
+	uint32_t cs = cs_enter(CS_EXTI_SLOTS);
+
+	stats->count = r->head;
+	stats->dropped = r->dropped;
+	stats->overflows = r->overflows;
+	stats->pending = r->head - r->tail;
+	cs_exit(cs);
+}
+
+static volatile uint32_t bench_calls;
+
+static void bench_handler(uint16_t pin, void *ctx)
+{
+	bench_calls++;
+}
+
+#define EXTI_BENCH_ROUNDS 1000
+
+// SWIER로 PR만 세우고(EXTI15_10 벡터는 잠시 막음) 처리 경로만 잰다.
+// hal_*: HAL_GPIO_EXTI_IRQHandler(핀) 방식, table_*: exti_dispatch 방식.
+// *_one은 B1 라인 하나, *_all은 10~15 여섯 라인이 모두 걸린 경우의 평균 사이클.
+// stamp_one은 B1에 시각 남기기를 켠 table_one (링은 매번 비운다).
+void exti_bench(uint32_t *hal_one, uint32_t *table_one, uint32_t *stamp_one, uint32_t *hal_all, uint32_t *table_all)
+{
+	exti_slot_t saved[6];
+	stamp_ring_t *b1 = &rings[__builtin_ctz(B1_Pin)];
+	uint32_t imr = EXTI->IMR;
+	uint32_t stamped = stamp_lines;
+	uint32_t enabled = NVIC_GetEnableIRQ(EXTI15_10_IRQn);
+	uint32_t sum[5] = { 0 };
+
+	dwt_init();
+	HAL_NVIC_DisableIRQ(EXTI15_10_IRQn);
+	for (int i = 0; i < 6; ++i)
+	{
+		saved[i] = slots[10 + i];
+		slots[10 + i].handler = bench_handler;
+		slots[10 + i].ctx = NULL;
+	}
+	EXTI->IMR = imr | EXTI_LINES_15_10;
+
+	for (int r = 0; r < EXTI_BENCH_ROUNDS; ++r)
+	{
+		uint32_t start;
+
+		EXTI->SWIER = B1_Pin;
+		start = dwt_cycles();
+		HAL_GPIO_EXTI_IRQHandler(B1_Pin);
+		sum[0] += dwt_cycles() - start;
+
+		EXTI->SWIER = B1_Pin;
+		start = dwt_cycles();
+		exti_dispatch(EXTI_LINES_15_10);
+		sum[1] += dwt_cycles() - start;
+
+		stamp_lines = stamped | B1_Pin;
+		b1->tail = b1->head;
+		EXTI->SWIER = B1_Pin;
+		start = dwt_cycles();
+		exti_dispatch(EXTI_LINES_15_10);
+		sum[4] += dwt_cycles() - start;
+		stamp_lines = stamped;
+
+		// HAL 방식으로 묶인 라인을 다 처리하려면 핀마다 한 번씩 불러야 한다
+		EXTI->SWIER = EXTI_LINES_15_10;
+		start = dwt_cycles();
+		for (uint16_t pin = GPIO_PIN_10; pin != 0; pin <<= 1) {
+			HAL_GPIO_EXTI_IRQHandler(pin);
+		}
+		sum[2] += dwt_cycles() - start;
+
+		EXTI->SWIER = EXTI_LINES_15_10;
+		start = dwt_cycles();
+		exti_dispatch(EXTI_LINES_15_10);
+		sum[3] += dwt_cycles() - start;
+	}
+
+	for (int i = 0; i < 6; ++i) {
+		slots[10 + i] = saved[i];
+	}
+	exti_stamp_enable(B1_Pin, (stamped & B1_Pin) != 0);
+	EXTI->IMR = imr;
+	EXTI->PR = EXTI_LINES_15_10;
+	NVIC_ClearPendingIRQ(EXTI15_10_IRQn);
+	if (enabled) {
+		HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+	}
+
+	*hal_one = sum[0] / EXTI_BENCH_ROUNDS;
+	*table_one = sum[1] / EXTI_BENCH_ROUNDS;
+	*stamp_one = sum[4] / EXTI_BENCH_ROUNDS;
+	*hal_all = sum[2] / EXTI_BENCH_ROUNDS;
+	*table_all = sum[3] / EXTI_BENCH_ROUNDS;
+}
+
+static void exti_cmd_bench(const char *args)
+{
+	uint32_t hal_one, table_one, stamp_one, hal_all, table_all;
+
+	exti_bench(&hal_one, &table_one, &stamp_one, &hal_all, &table_all);
+	console_printf("extibench 1 line : HAL %lu, table %lu, table + stamp %lu cycles\r\n",
+	               (unsigned long)hal_one, (unsigned long)table_one, (unsigned long)stamp_one);
+	console_printf("extibench 6 lines: HAL %lu, table %lu cycles\r\n",
+	               (unsigned long)hal_all, (unsigned long)table_all);
+}
+
+// 이보다 가까운 엣지는 같은 누름의 채터링으로 본다
+#define EDGE_BOUNCE_US 5000U
+
+// ms 동안 B1의 양쪽 엣지 시각을 모아 채터링과 실제 누름을 가른다
+static void exti_cmd_edges(const char *args)
+{
+	unsigned long ms = 5000;
+	uint32_t bounce = EDGE_BOUNCE_US * (SystemCoreClock / 1000000U);
+	uint32_t rtsr = EXTI->RTSR, ftsr = EXTI->FTSR, imr = EXTI->IMR;
+	uint32_t edges = 0, groups = 0, bounces = 0;
+	uint32_t shortest = UINT32_MAX, longest_group = 0;
+	uint32_t prev = 0, group_start = 0, t, start;
+	exti_stamp_stats_t st;
+
+	sscanf(args, "%lu", &ms);
+	console_printf("edges: press B1 for %lu ms\r\n", ms);
+
+	exti_stamp_enable(B1_Pin, true);
+	bb_set(&EXTI->RTSR, 13);
+	bb_set(&EXTI->FTSR, 13);
+	bb_set(&EXTI->IMR, 13);
+
+	start = HAL_GetTick();
+	while (HAL_GetTick() - start < ms)
+	{
+		while (exti_stamp_get(B1_Pin, &t))
+		{
+			uint32_t gap = t - prev;
+
+			if (edges == 0 || gap >= bounce)
+			{
+				groups++;
+				group_start = t;
+			}
+			else
+			{
+				bounces++;
+				if (gap < shortest) {
+					shortest = gap;
+				}
+				if (t - group_start > longest_group) {
+					longest_group = t - group_start;
+				}
+			}
+			prev = t;
+			edges++;
+		}
+	}
+
+	EXTI->RTSR = rtsr;
+	EXTI->FTSR = ftsr;
+	EXTI->IMR = imr;
+	exti_stamp_stats(B1_Pin, &st);
+	exti_stamp_enable(B1_Pin, false);
+
+	console_printf("edges: %lu edges, %lu groups, %lu bounce edges, %lu dropped (%lu overflows)\r\n",
+	               (unsigned long)edges, (unsigned long)groups, (unsigned long)bounces,
+	               (unsigned long)st.dropped, (unsigned long)st.overflows);
+	if (bounces)
+	{
+		console_printf("edges: shortest gap %lu ns, longest bounce burst %lu ns\r\n",
+		               (unsigned long)dwt_cycles_to_ns(shortest),
+		               (unsigned long)dwt_cycles_to_ns(longest_group));
+	}
+}
+
+// 측정용 콘솔 명령. 버튼 라인을 빌려 쓰므로 평소 데모에서는 부르지 않는다(14가 부른다)
+void exti_bench_init(void)
+{
+	console_register("extibench", exti_cmd_bench);
+	console_register("edges", exti_cmd_edges);
+}
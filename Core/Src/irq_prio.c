@@ -0,0 +1,174 @@
+// 우선순위 계획 측정 (priobench)
+//
+// 가장 높은 레벨의 탐침 IRQ(TIM11)가 낮은 IRQ들이 몰아치는 동안 얼마나 늦게 들어오는지 잰다.
+// TIM11과 TIM9는 APB2(84MHz, 분주 없음)라 CNT 한 칸이 CPU 한 사이클이고,
+// 업데이트 순간 CNT가 0이 되므로 핸들러 첫 줄에서 읽은 CNT가 곧 진입 지연이다.
+// 부하는 TIM9 폭주(5us마다, 한 번에 약 2us), 평소대로 도는 TIM2 틱,
+// 그리고 메인 루프가 반복해서 잡는 임계 구역이다.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "main.h"
+#include "dwt.h"
+#include "irq_prio.h"
+#include "uart_console.h"
+
+#define PROBE_PERIOD    8400U   // 100us
+#define LOAD_PERIOD     420U    // 5us
+#define LOAD_WORK       168U    // TIM9 핸들러 한 번에 쓰는 사이클 (2us)
+#define BENCH_PHASE_MS  200U
+
+static volatile uint32_t probe_count, probe_sum, probe_max, probe_nested;
+static volatile uint32_t load_count;
+static volatile bool in_load;
+
+static inline void spin(uint32_t cycles)
+{
+	uint32_t start = dwt_cycles();
+
+	while (dwt_cycles() - start < cycles) {
+	}
+}
+
+// TIM1_TRG_COM_TIM11_IRQHandler에서 호출
+void irq_prio_probe_irq(void)
+{
+	uint32_t late = TIM11->CNT;
+
+	TIM11->SR = ~TIM_SR_UIF;
+	probe_count++;
+	probe_sum += late;
+	if (late > probe_max) {
+		probe_max = late;
+	}
+	if (in_load) {
+		probe_nested++;
+	}
+}
+
+// TIM1_BRK_TIM9_IRQHandler에서 호출
+void irq_prio_load_irq(void)
+{
+	TIM9->SR = ~TIM_SR_UIF;
+	in_load = true;
+	spin(LOAD_WORK);
+	in_load = false;
+	load_count++;
+}
+
+static void timer_start(TIM_TypeDef *tim, uint32_t period)
+{
+	tim->CR1 = 0;
+	tim->PSC = 0;
+	tim->ARR = period - 1U;
+	tim->CNT = 0;
+	tim->EGR = TIM_EGR_UG;
+	tim->SR = 0;
+	tim->DIER = TIM_DIER_UIE;
+	tim->CR1 = TIM_CR1_CEN;
+}
+
+static void timer_stop(TIM_TypeDef *tim)
+{
+	tim->CR1 = 0;
+	tim->DIER = 0;
+	tim->SR = 0;
+}
+
+static void run_phase(prio_bench_mode_t mode, uint32_t section, prio_bench_t *res)
+{
+	uint32_t phase = SystemCoreClock / 1000U * BENCH_PHASE_MS;
+	uint32_t start;
+
+	// 탐침을 멈춘 채로 카운터를 지운다
+	TIM11->DIER = 0;
+	probe_count = probe_sum = probe_max = probe_nested = 0;
+	load_count = 0;
+	if (mode != PRIO_BENCH_IDLE) {
+		timer_start(TIM9, LOAD_PERIOD);
+	}
+	timer_start(TIM11, PROBE_PERIOD);
+
+	start = dwt_cycles();
+	while (dwt_cycles() - start < phase)
+	{
+		if (mode == PRIO_BENCH_BASEPRI)
+		{
+			uint32_t cs = cs_enter(CS_TIM2_JOBS);
+			spin(section);
+			cs_exit(cs);
+		}
+		else if (mode == PRIO_BENCH_PRIMASK)
+		{
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			spin(section);
+			__set_PRIMASK(primask);
+		}
+		// 구역 밖에서도 같은 시간을 보낸다 (점유율 50%)
+		spin(section);
+	}
+
+	timer_stop(TIM11);
+	timer_stop(TIM9);
+	res->count = probe_count;
+	res->avg = probe_count ? probe_sum / probe_count : 0;
+	res->max = probe_max;
+	res->nested = probe_nested;
+	res->load = load_count;
+}
+
+// 메인 루프(스레드 모드)에서 호출. section_us는 메인 루프 임계 구역 한 번의 길이
+void irq_prio_bench(uint32_t section_us, prio_bench_t result[PRIO_BENCH_MODES])
+{
+	uint32_t section = section_us * (SystemCoreClock / 1000000U);
+
+	dwt_init();
+	__HAL_RCC_TIM9_CLK_ENABLE();
+	__HAL_RCC_TIM11_CLK_ENABLE();
+	HAL_NVIC_SetPriority(TIM1_TRG_COM_TIM11_IRQn, IRQ_PRIO_PROBE, 0);
+	HAL_NVIC_SetPriority(TIM1_BRK_TIM9_IRQn, IRQ_PRIO_LOAD, 0);
+	HAL_NVIC_EnableIRQ(TIM1_TRG_COM_TIM11_IRQn);
+	HAL_NVIC_EnableIRQ(TIM1_BRK_TIM9_IRQn);
+
+	for (int m = 0; m < PRIO_BENCH_MODES; ++m) {
+		run_phase((prio_bench_mode_t)m, section, &result[m]);
+	}
+
+	HAL_NVIC_DisableIRQ(TIM1_TRG_COM_TIM11_IRQn);
+	HAL_NVIC_DisableIRQ(TIM1_BRK_TIM9_IRQn);
+	NVIC_ClearPendingIRQ(TIM1_TRG_COM_TIM11_IRQn);
+	NVIC_ClearPendingIRQ(TIM1_BRK_TIM9_IRQn);
+	__HAL_RCC_TIM9_CLK_DISABLE();
+	__HAL_RCC_TIM11_CLK_DISABLE();
+}
+
+// 최고 레벨 IRQ의 진입 지연을 부하 없이 / BASEPRI 구역 / PRIMASK 구역에서 비교한다.
+// 탐침 주기가 100us라 section_us는 그보다 짧아야 한다
+static void irq_prio_cmd_bench(const char *args)
+{
+	static const char *const name[PRIO_BENCH_MODES] = { "idle   ", "basepri", "primask" };
+	prio_bench_t res[PRIO_BENCH_MODES];
+	unsigned long section_us = 20;
+
+	sscanf(args, "%lu", &section_us);
+	if (section_us == 0 || section_us > 90)
+	{
+		console_printf("usage: priobench [section_us 1..90]\r\n");
+		return;
+	}
+
+	irq_prio_bench(section_us, res);
+	for (int m = 0; m < PRIO_BENCH_MODES; ++m)
+	{
+		console_printf("priobench %s: n %lu, avg %lu, max %lu cycles (%lu ns), nested %lu/%lu\r\n", name[m],
+		               (unsigned long)res[m].count, (unsigned long)res[m].avg, (unsigned long)res[m].max,
+		               (unsigned long)dwt_cycles_to_ns(res[m].max),
+		               (unsigned long)res[m].nested, (unsigned long)res[m].load);
+	}
+}
+
+void irq_prio_bench_init(void)
+{
+	console_register("priobench", irq_prio_cmd_bench);
+}
@@ -29,6 +29,16 @@
 #include "05_interrupt.h"
 #include "06_register_control.h"
 #include "07_traffic_light.h"
+#include "08_pwm_dither.h"
+#include "08_pwm_wave.h"
+#include "09_color.h"
+#include "10_led_fx.h"
+#include "11_blink_hw.h"
+#include "12_pcm.h"
+#include "13_icap.h"
+#include "14_latency.h"
+#include "15_inputs.h"
+#include "irq_prio.h"
 #include "tm1637.h"
 
 /* USER CODE END Includes */
@@ -121,7 +131,17 @@ int main(void)
 //  led_polling_run();    // 04
 //  led_interrupt_run();  // 05
 //  gpio_register_run();  // 06 베어메탈 코드이므로 HAL INIT 주석처리해야함
+//  gpio_register_wfe_run(); // 06 WFE 이벤트 버전 (HAL INIT 주석처리)
   traffic_light_run();    // 07
+//  pwm_wave_run();       // 08
+//  pwm_dither_run();     // 08 디더링
+//  color_run();          // 09
+//  fx_run();             // 10
+//  blink_hw_run();       // 11
+//  pcm_run();            // 12
+//  icap_run();           // 13
+//  latency_run();        // 14
+//  inputs_run();         // 15
 
   /* USER CODE END 2 */
 
@@ -329,7 +349,7 @@ static void MX_GPIO_Init(void)
   HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
   /* USER CODE BEGIN MX_GPIO_Init_2 */
-  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, IRQ_PRIO_EXTI, 0);
 	HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
   /* USER CODE END MX_GPIO_Init_2 */
 }
@@ -0,0 +1,294 @@
+// 포트 단위 입력 스캐너
+//
+// TIM4 10kHz마다 구독된 핀이 있는 포트의 IDR을 한 번씩 읽고 지난 스냅샷과 XOR해서,
+// 바뀐 비트만 CTZ로 하나씩 꺼내 그 핀의 구독자에게 넘긴다. 아무것도 안 바뀌면
+// 포트당 IDR 읽기, XOR, 비교 하나로 끝나므로 구독한 핀 수와 거의 상관없다.
+// 디바운스는 하지 않는다. 필요하면 구독자가 한다(스캔 간격 100us).
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "dwt.h"
+#include "gpio_fast.h"
+#include "irq_prio.h"
+#include "port_scan.h"
+#include "reg.h"
+#include "uart_console.h"
+
+#define AVG_SHIFT 10                    // 1024번마다 평균을 갱신
+#define BENCH_ROUNDS 1000
+#define BENCH_SUB PORT_SCAN_MAX_SUB     // scanbench가 잠시 쓰는 구독자 자리
+
+typedef struct {
+	port_scan_handler_t handler;
+	void *ctx;
+} scan_sub_t;
+
+typedef struct {
+	GPIO_TypeDef *gpio;
+	uint32_t mask;        // 구독된 핀
+	uint32_t prev;        // 지난 스캔의 IDR
+	uint8_t sub[16];      // 핀 번호 -> 구독자
+} scan_port_t;
+
+static scan_port_t ports[PORT_SCAN_PORTS] = { { .gpio = GPIOA }, { .gpio = GPIOB }, { .gpio = GPIOC } };
+static scan_sub_t subs[PORT_SCAN_MAX_SUB + 1];
+static uint8_t sub_count = 0;
+
+static volatile uint32_t scans = 0;
+static volatile uint32_t changes = 0;
+static volatile uint32_t cycles_last, cycles_avg, cycles_max;
+static uint32_t window_sum;
+
+static void scan_cmd_status(const char *args);
+static void scan_cmd_bench(const char *args);
+
+// 구독자에게 넘긴 비트 수를 돌려준다
+static uint32_t scan_once(void)
+{
+	uint32_t count = 0;
+
+	for (int p = 0; p < PORT_SCAN_PORTS; ++p)
+	{
+		scan_port_t *sp = &ports[p];
+		uint32_t idr, changed;
+
+		if (sp->mask == 0) {
+			continue;
+		}
+		idr = sp->gpio->IDR;
+		changed = (idr ^ sp->prev) & sp->mask;
+		if (changed == 0) {
+			continue;
+		}
+		sp->prev = idr;
+
+		while (changed)
+		{
+			uint32_t n = (uint32_t)__builtin_ctz(changed);
+			scan_sub_t *s = &subs[sp->sub[n]];
+
+			changed &= changed - 1;
+			s->handler(sp->gpio, (uint16_t)(1U << n), (idr >> n) & 1U, s->ctx);
+			count++;
+		}
+	}
+	return count;
+}
+
+// TIM4_IRQHandler에서 호출. 사이클은 예외 진입을 뺀 핸들러 본문
+void port_scan_irq(void)
+{
+	uint32_t start = dwt_cycles();
+	uint32_t cycles;
+
+	TIM4->SR = ~TIM_SR_UIF;
+	changes += scan_once();
+	scans++;
+
+	cycles = dwt_cycles() - start;
+	cycles_last = cycles;
+	if (cycles > cycles_max) {
+		cycles_max = cycles;
+	}
+	window_sum += cycles;
+	if ((scans & ((1U << AVG_SHIFT) - 1U)) == 0)
+	{
+		cycles_avg = window_sum >> AVG_SHIFT;
+		window_sum = 0;
+	}
+}
+
+void port_scan_init(void)
+{
+	static bool initialized = false;
+
+	if (initialized) {
+		return;
+	}
+
+	dwt_init();
+	// TIM4는 APB1 타이머 클럭(84MHz = SystemCoreClock)으로 센다
+	__HAL_RCC_TIM4_CLK_ENABLE();
+	TIM4->CR1 = 0;
+	TIM4->PSC = 0;
+	TIM4->ARR = SystemCoreClock / PORT_SCAN_HZ - 1U;
+	TIM4->CNT = 0;
+	TIM4->EGR = TIM_EGR_UG;
+	TIM4->SR = 0;
+	TIM4->DIER = TIM_DIER_UIE;
+	HAL_NVIC_SetPriority(TIM4_IRQn, IRQ_PRIO_SCAN, 0);
+	HAL_NVIC_EnableIRQ(TIM4_IRQn);
+	TIM4->CR1 = TIM_CR1_CEN;
+
+	console_register("scan", scan_cmd_status);
+	console_register("scanbench", scan_cmd_bench);
+	initialized = true;
+}
+
+// 핀은 입력으로 이미 설정되어 있어야 한다. 한 핀에는 구독자 하나.
+// 호출마다 구독자가 하나씩 생기고 그 번호를 돌려준다 (실패하면 -1)
+int port_scan_subscribe(GPIO_TypeDef *port, uint16_t pins, port_scan_handler_t handler, void *ctx)
+{
+	uint32_t p = GPIO_PORT_INDEX(port);
+	scan_port_t *sp;
+	uint32_t cs;
+	int id;
+
+	if (p >= PORT_SCAN_PORTS || pins == 0 || handler == NULL || sub_count >= PORT_SCAN_MAX_SUB) {
+		return -1;
+	}
+	sp = &ports[p];
+	if (sp->mask & pins) {
+		return -1;
+	}
+
+	id = sub_count;
+	port_clock_enable(1UL << p);
+
+	cs = cs_enter(CS_SCAN_TABLE);
+	subs[id].handler = handler;
+	subs[id].ctx = ctx;
+	for (uint32_t bits = pins; bits; bits &= bits - 1) {
+		sp->sub[__builtin_ctz(bits)] = (uint8_t)id;
+	}
+	// 새 핀은 지금 레벨에서 시작해서 첫 스캔에 가짜 변화가 나오지 않게 한다
+	sp->prev = (sp->prev & ~(uint32_t)pins) | (port->IDR & pins);
+	sp->mask |= pins;
+	sub_count++;
+	cs_exit(cs);
+
+	return id;
+}
+
+void port_scan_get_stats(port_scan_stats_t *stats)
+{
+	uint32_t cs = cs_enter(CS_SCAN_TABLE);
+
+	stats->scans = scans;
+	stats->changes = changes;
+	stats->cycles_last = cycles_last;
+	stats->cycles_avg = cycles_avg;
+	stats->cycles_max = cycles_max;
+	stats->inputs = 0;
+	for (int p = 0; p < PORT_SCAN_PORTS; ++p) {
+		stats->inputs += (uint32_t)__builtin_popcount(ports[p].mask);
+	}
+	cs_exit(cs);
+}
+
+// 스캔 한 번의 사이클을 10kHz에서의 CPU 점유율(0.01% 단위)로
+static uint32_t load_x100(uint32_t cycles)
+{
+	return (uint32_t)((uint64_t)cycles * PORT_SCAN_HZ * 10000U / SystemCoreClock);
+}
+
+static void scan_cmd_status(const char *args)
+{
+	port_scan_stats_t st;
+	uint32_t load;
+
+	port_scan_get_stats(&st);
+	load = load_x100(st.cycles_avg);
+	console_printf("scan: %lu inputs, %lu scans, %lu changes\r\n",
+	               (unsigned long)st.inputs, (unsigned long)st.scans, (unsigned long)st.changes);
+	console_printf("scan: last %lu, avg %lu, max %lu cycles/scan, %lu.%02lu%% CPU\r\n",
+	               (unsigned long)st.cycles_last, (unsigned long)st.cycles_avg, (unsigned long)st.cycles_max,
+	               (unsigned long)(load / 100), (unsigned long)(load % 100));
+}
+
+static volatile uint32_t bench_calls;
+
+static void bench_handler(GPIO_TypeDef *port, uint16_t pin, bool level, void *ctx)
+{
+	bench_calls++;
+}
+
+// A/B/C 48핀을 모두 bench_handler에 붙이고 TIM4 IRQ만 끈 채 스캔 본문만 잰다.
+// SysTick, TIM2 같은 다른 IRQ는 그대로 돌므로 결과에 약간 섞일 수 있다.
+// quiet: 바뀐 핀 없음, all: 매번 48핀이 다 바뀜(스냅샷을 뒤집어 둔다, 뒤집는 비용은 뺀다),
+// pin: 같은 48핀을 핀마다 gpio_read로 읽어 지난 레벨과 비교하는 방식
+static void scan_cmd_bench(const char *args)
+{
+	static uint8_t level[PORT_SCAN_PORTS * 16];
+	scan_port_t saved[PORT_SCAN_PORTS];
+	uint32_t enabled = NVIC_GetEnableIRQ(TIM4_IRQn);
+	uint32_t start, quiet, all, flip, pin, calls;
+
+	// 표를 만지는 건 TIM4 ISR뿐이라 그것만 끄면 된다. 몇십 ms 동안 BASEPRI로 SysTick까지 막지 않는다
+	HAL_NVIC_DisableIRQ(TIM4_IRQn);
+	memcpy(saved, ports, sizeof(ports));
+	subs[BENCH_SUB].handler = bench_handler;
+	subs[BENCH_SUB].ctx = NULL;
+	for (int p = 0; p < PORT_SCAN_PORTS; ++p)
+	{
+		memset(ports[p].sub, BENCH_SUB, sizeof(ports[p].sub));
+		ports[p].mask = 0xFFFFU;
+		ports[p].prev = ports[p].gpio->IDR;
+	}
+
+	start = dwt_cycles();
+	for (int r = 0; r < BENCH_ROUNDS; ++r) {
+		scan_once();
+	}
+	quiet = dwt_cycles() - start;
+
+	start = dwt_cycles();
+	for (int r = 0; r < BENCH_ROUNDS; ++r)
+	{
+		for (int p = 0; p < PORT_SCAN_PORTS; ++p) {
+			ports[p].prev ^= 0xFFFFU;
+		}
+		__asm volatile("" ::: "memory");
+	}
+	flip = dwt_cycles() - start;
+
+	bench_calls = 0;
+	start = dwt_cycles();
+	for (int r = 0; r < BENCH_ROUNDS; ++r)
+	{
+		for (int p = 0; p < PORT_SCAN_PORTS; ++p) {
+			ports[p].prev ^= 0xFFFFU;
+		}
+		scan_once();
+	}
+	all = dwt_cycles() - start - flip;
+	calls = bench_calls;
+
+	for (int i = 0; i < PORT_SCAN_PORTS * 16; ++i) {
+		level[i] = gpio_read(ports[i >> 4].gpio, (uint16_t)(1U << (i & 15)));
+	}
+	start = dwt_cycles();
+	for (int r = 0; r < BENCH_ROUNDS; ++r)
+	{
+		for (int i = 0; i < PORT_SCAN_PORTS * 16; ++i)
+		{
+			GPIO_TypeDef *port = ports[i >> 4].gpio;
+			uint16_t bit = (uint16_t)(1U << (i & 15));
+			bool now = gpio_read(port, bit);
+
+			if (now != level[i])
+			{
+				level[i] = now;
+				bench_handler(port, bit, now, NULL);
+			}
+		}
+	}
+	pin = dwt_cycles() - start;
+
+	memcpy(ports, saved, sizeof(ports));
+	// 그동안 선 UIF는 남겨 두어 다시 켜자마자 한 번 스캔하게 한다
+	if (enabled) {
+		HAL_NVIC_EnableIRQ(TIM4_IRQn);
+	}
+
+	quiet /= BENCH_ROUNDS;
+	all /= BENCH_ROUNDS;
+	pin /= BENCH_ROUNDS;
+	console_printf("scanbench 48 inputs: quiet %lu, all changed %lu, pin by pin %lu cycles/scan\r\n",
+	               (unsigned long)quiet, (unsigned long)all, (unsigned long)pin);
+	console_printf("scanbench 10 kHz: quiet %lu.%02lu%%, all changed %lu.%02lu%% CPU (%lu calls)\r\n",
+	               (unsigned long)(load_x100(quiet) / 100), (unsigned long)(load_x100(quiet) % 100),
+	               (unsigned long)(load_x100(all) / 100), (unsigned long)(load_x100(all) % 100),
+	               (unsigned long)calls);
+}
@@ -0,0 +1,53 @@
+// PWM 밝기 보정 테이블
+//
+// GCC는 상수 인자의 __builtin_pow/__builtin_cos를 컴파일 중에 계산하므로
+// 아래 초기화식은 런타임 코드 없이 .rodata(플래시)에 그대로 들어간다.
+
+#include <math.h>
+#include "main.h"
+#include "pwm_lut.h"
+#include "dwt.h"
+
+#define LUT_PI 3.14159265358979323846
+
+#define LUT_X(i) ((double)(i) / (PWM_LUT_LEVELS - 1))
+#define LUT_CCR(y) (uint16_t)(PWM_LUT_FULL * (y) + 0.5)
+
+#define GAMMA22(i) LUT_CCR(__builtin_pow(LUT_X(i), 2.2)),
+#define SINE(i)    LUT_CCR((1.0 - __builtin_cos(LUT_PI * LUT_X(i))) / 2.0),
+#define CUBIC(i)   LUT_CCR((LUT_X(i) < 0.5) \
+                           ? 4.0 * LUT_X(i) * LUT_X(i) * LUT_X(i) \
+                           : 1.0 - (2.0 - 2.0 * LUT_X(i)) * (2.0 - 2.0 * LUT_X(i)) \
+                                   * (2.0 - 2.0 * LUT_X(i)) / 2.0),
+
+#define REP4(F, i)  F(i) F((i) + 1) F((i) + 2) F((i) + 3)
+#define REP16(F, i) REP4(F, i) REP4(F, (i) + 4) REP4(F, (i) + 8) REP4(F, (i) + 12)
+#define REP64(F, i) REP16(F, i) REP16(F, (i) + 16) REP16(F, (i) + 32) REP16(F, (i) + 48)
+#define REP256(F)   REP64(F, 0) REP64(F, 64) REP64(F, 128) REP64(F, 192)
+
+const uint16_t pwm_lut[PWM_CURVE_COUNT][PWM_LUT_LEVELS] = {
+	[PWM_CURVE_GAMMA22] = { REP256(GAMMA22) },
+	[PWM_CURVE_SINE]    = { REP256(SINE) },
+	[PWM_CURVE_CUBIC]   = { REP256(CUBIC) },
+};
+
+// 256단계 전체를 테이블 조회와 powf 계산으로 각각 변환하는 데 걸린 사이클
+void pwm_lut_bench(uint32_t *lut_cycles, uint32_t *powf_cycles)
+{
+	volatile uint16_t sink;
+	uint32_t start;
+
+	start = dwt_cycles();
+	for (uint32_t i = 0; i < PWM_LUT_LEVELS; ++i) {
+		sink = pwm_lut_ccr(PWM_CURVE_GAMMA22, (uint8_t)i);
+	}
+	*lut_cycles = dwt_cycles() - start;
+
+	start = dwt_cycles();
+	for (uint32_t i = 0; i < PWM_LUT_LEVELS; ++i) {
+		sink = (uint16_t)(PWM_LUT_FULL * powf((float)i / (PWM_LUT_LEVELS - 1), 2.2f) + 0.5f);
+	}
+	*powf_cycles = dwt_cycles() - start;
+
+	(void)sink;
+}
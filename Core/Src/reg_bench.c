@@ -0,0 +1,140 @@
+// 헤더만 있는 레지스터 계층(reg.h, gpio_fast.h, bitband.h)의 한 번당 사이클 측정
+//
+// 계층 자체는 인라인 함수뿐이라 .c가 없으므로 벤치는 여기 모아 둔다.
+// 측정 루프는 reg_bench.h의 REG_BENCH.
+
+#include <stdio.h>
+#include "main.h"
+#include "bitband.h"
+#include "dwt.h"
+#include "gpio_fast.h"
+#include "reg.h"
+#include "reg_bench.h"
+#include "uart_console.h"
+
+// 06의 옛 방식(주소 매크로, 손으로 쓴 시프트)과 reg.h, HAL을 비교한다
+static void reg_bench_cmd_reg(const char *args)
+{
+	volatile uint32_t *bsrr_macro = (volatile uint32_t *)(0x40020000UL + 0x18);
+	volatile uint32_t *moder_macro = (volatile uint32_t *)(0x40020000UL + 0x00);
+	uint32_t empty, macro, layer, hal, split, batched;
+
+	dwt_init();
+	REG_BENCH(empty, (void)0);
+	REG_BENCH(macro, *bsrr_macro = (1U << 5));
+	REG_BENCH(layer, pin_set(PIN_LD2));
+	REG_BENCH(hal, HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_SET));
+	// LD2 모드(출력)와 PA6 모드를 지금 값 그대로 다시 쓴다
+	REG_BENCH(split, {
+		uint32_t mode6 = reg_field(GPIOA->MODER, 12, 2);
+		*moder_macro &= ~(0x3U << (5 * 2));
+		*moder_macro |= (0x1U << (5 * 2));
+		*moder_macro &= ~(0x3U << (6 * 2));
+		*moder_macro |= (mode6 << (6 * 2));
+	});
+	REG_BENCH(batched, {
+		uint32_t mode6 = reg_field(GPIOA->MODER, 12, 2);
+		reg_modify(&GPIOA->MODER, GPIO_MASK2(5) | GPIO_MASK2(6),
+		           GPIO_VAL2(5, PIN_MODE_OUTPUT) | GPIO_VAL2(6, mode6));
+	});
+	gpio_clear(LD2_GPIO_Port, LD2_Pin);
+
+	console_printf("regbench set   : macro %lu, pin_set %lu, HAL_GPIO_WritePin %lu cycles\r\n",
+	               (unsigned long)((macro - empty) / REG_BENCH_ROUNDS),
+	               (unsigned long)((layer - empty) / REG_BENCH_ROUNDS),
+	               (unsigned long)((hal - empty) / REG_BENCH_ROUNDS));
+	console_printf("regbench moder : 2 fields split %lu, reg_modify %lu cycles\r\n",
+	               (unsigned long)((split - empty) / REG_BENCH_ROUNDS),
+	               (unsigned long)((batched - empty) / REG_BENCH_ROUNDS));
+}
+
+#define LAMP_PINS (GPIO_PIN_6 | GPIO_PIN_8 | GPIO_PIN_9)
+
+// HAL_GPIO_* 와 gpio_fast.h 한 번당 사이클
+static void reg_bench_cmd_gpio(const char *args)
+{
+	static const char *const op[] = { "set   ", "write ", "toggle", "read  ", "3 pins" };
+	uint32_t empty, t[10];
+	volatile bool sink;
+	bool on = false;
+
+	dwt_init();
+	REG_BENCH(empty, (void)0);
+	REG_BENCH(t[0], HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_SET));
+	REG_BENCH(t[1], gpio_set(LD2_GPIO_Port, LD2_Pin));
+	REG_BENCH(t[2], HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, (on = !on) ? GPIO_PIN_SET : GPIO_PIN_RESET));
+	REG_BENCH(t[3], gpio_write(LD2_GPIO_Port, LD2_Pin, on = !on));
+	REG_BENCH(t[4], HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin));
+	REG_BENCH(t[5], gpio_toggle(LD2_GPIO_Port, LD2_Pin));
+	REG_BENCH(t[6], sink = (HAL_GPIO_ReadPin(B1_GPIO_Port, B1_Pin) == GPIO_PIN_SET));
+	REG_BENCH(t[7], sink = gpio_read(B1_GPIO_Port, B1_Pin));
+	// 램프 세 개를 빨강만 켠 상태로 (set_leds 모양)
+	REG_BENCH(t[8], {
+		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_6, GPIO_PIN_SET);
+		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_8, GPIO_PIN_RESET);
+		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_9, GPIO_PIN_RESET);
+	});
+	REG_BENCH(t[9], gpio_write_mask(GPIOC, LAMP_PINS, GPIO_PIN_6));
+	(void)sink;
+	gpio_clear(LD2_GPIO_Port, LD2_Pin);
+	gpio_clear(GPIOC, LAMP_PINS);
+
+	for (int i = 0; i < 5; ++i)
+	{
+		console_printf("gpiobench %s: HAL %lu, fast %lu cycles\r\n", op[i],
+		               (unsigned long)((t[2 * i] - empty) / REG_BENCH_ROUNDS),
+		               (unsigned long)((t[2 * i + 1] - empty) / REG_BENCH_ROUNDS));
+	}
+}
+
+// 한 비트 플래그를 올렸다 내리는 네 가지 방법. 메인 루프 쪽에서 ISR과 공유하는 변수를 바꾸는 비용
+static void reg_bench_cmd_bit(const char *args)
+{
+	static flagset_t fs;
+	static volatile uint32_t word;
+	uint32_t empty, t[4];
+
+	dwt_init();
+	REG_BENCH(empty, (void)0);
+	// 일반 읽기-수정-쓰기: 빠르지만 ISR이 사이에 끼면 그쪽 비트가 사라진다
+	REG_BENCH(t[0], {
+		word |= 1U << 3;
+		word &= ~(1U << 3);
+	});
+	REG_BENCH(t[1], {
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		word |= 1U << 3;
+		__set_PRIMASK(primask);
+		primask = __get_PRIMASK();
+		__disable_irq();
+		word &= ~(1U << 3);
+		__set_PRIMASK(primask);
+	});
+	REG_BENCH(t[2], {
+		uint32_t v;
+		do {
+			v = __LDREXW(&word);
+		} while (__STREXW(v | (1U << 3), &word));
+		do {
+			v = __LDREXW(&word);
+		} while (__STREXW(v & ~(1U << 3), &word));
+	});
+	REG_BENCH(t[3], {
+		flag_raise(&fs, 3);
+		flag_clear(&fs, 3);
+	});
+
+	console_printf("bitbench set+clear: plain RMW %lu, PRIMASK %lu, LDREX/STREX %lu, bit-band %lu cycles\r\n",
+	               (unsigned long)((t[0] - empty) / REG_BENCH_ROUNDS),
+	               (unsigned long)((t[1] - empty) / REG_BENCH_ROUNDS),
+	               (unsigned long)((t[2] - empty) / REG_BENCH_ROUNDS),
+	               (unsigned long)((t[3] - empty) / REG_BENCH_ROUNDS));
+}
+
+void reg_bench_init(void)
+{
+	console_register("regbench", reg_bench_cmd_reg);
+	console_register("gpiobench", reg_bench_cmd_gpio);
+	console_register("bitbench", reg_bench_cmd_bit);
+}
@@ -0,0 +1,201 @@
+// F411 내장 RTC (레지스터 직접 제어). LSE 우선, 없으면 LSI 사용
+
+#include "main.h"
+#include "irq_prio.h"
+#include "rtc_clock.h"
+
+#define LSE_TIMEOUT_MS 2000
+#define RTC_TIMEOUT_MS 100
+
+// ck_spre = 1Hz 가 되도록 분주 (async + 1) * (sync + 1)
+#define PRER_ASYNC 127U
+#define PRER_SYNC_LSE 255U   // 32768Hz
+#define PRER_SYNC_LSI 249U   // 약 32kHz
+
+static rtc_alarm_cb_t alarm_cb = NULL;
+
+static uint8_t to_bcd(uint8_t v)
+{
+	return (uint8_t)(((v / 10) << 4) | (v % 10));
+}
+
+static uint8_t from_bcd(uint32_t v)
+{
+	return (uint8_t)(((v >> 4) & 0x0F) * 10 + (v & 0x0F));
+}
+
+// 1=월요일 ... 7=일요일 (RTC_DR WDU 형식)
+static uint8_t weekday(uint16_t year, uint8_t month, uint8_t day)
+{
+	static const uint8_t offset[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+
+	if (month < 3) {
+		year--;
+	}
+	uint8_t dow = (uint8_t)((year + year / 4 - year / 100 + year / 400 + offset[month - 1] + day) % 7);
+
+	return (dow == 0) ? 7 : dow;
+}
+
+static void rtc_unlock(void)
+{
+	RTC->WPR = 0xCA;
+	RTC->WPR = 0x53;
+}
+
+static void rtc_lock(void)
+{
+	RTC->WPR = 0xFF;
+}
+
+static bool wait_flag(volatile uint32_t *reg, uint32_t mask, uint32_t timeout_ms)
+{
+	uint32_t start = HAL_GetTick();
+
+	while (!(*reg & mask))
+	{
+		if (HAL_GetTick() - start > timeout_ms) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static uint32_t prer_sync(void)
+{
+	return ((RCC->BDCR & RCC_BDCR_RTCSEL) == RCC_BDCR_RTCSEL_1) ? PRER_SYNC_LSI : PRER_SYNC_LSE;
+}
+
+void rtc_clock_init(void)
+{
+	__HAL_RCC_PWR_CLK_ENABLE();
+	PWR->CR |= PWR_CR_DBP;   // 백업 도메인 쓰기 허용
+
+	if (!(RCC->BDCR & RCC_BDCR_RTCEN))
+	{
+		RCC->BDCR |= RCC_BDCR_LSEON;
+
+		if (wait_flag(&RCC->BDCR, RCC_BDCR_LSERDY, LSE_TIMEOUT_MS))
+		{
+			RCC->BDCR |= RCC_BDCR_RTCSEL_0;
+		}
+		else
+		{
+			RCC->BDCR &= ~RCC_BDCR_LSEON;
+			RCC->BDCR |= RCC_BDCR_RTCSEL_1;
+		}
+		RCC->BDCR |= RCC_BDCR_RTCEN;
+	}
+
+	// LSI는 시스템 리셋 때 꺼지므로 다시 켜야 한다
+	if ((RCC->BDCR & RCC_BDCR_RTCSEL) == RCC_BDCR_RTCSEL_1)
+	{
+		RCC->CSR |= RCC_CSR_LSION;
+		wait_flag(&RCC->CSR, RCC_CSR_LSIRDY, RTC_TIMEOUT_MS);
+	}
+
+	// 백업 도메인 리셋 직후라 달력이 비어 있으면 기본값으로 설정
+	if (!(RTC->ISR & RTC_ISR_INITS))
+	{
+		const rtc_time_t t = { 25, 1, 1, 0, 0, 0 };
+		rtc_clock_set(&t);
+	}
+
+	// 섀도 레지스터 동기화
+	rtc_unlock();
+	RTC->ISR &= ~RTC_ISR_RSF;
+	rtc_lock();
+	wait_flag(&RTC->ISR, RTC_ISR_RSF, RTC_TIMEOUT_MS);
+
+	// 알람 A -> EXTI17 상승 에지 -> RTC_Alarm_IRQn
+	EXTI->IMR |= EXTI_IMR_MR17;
+	EXTI->RTSR |= EXTI_RTSR_TR17;
+	HAL_NVIC_SetPriority(RTC_Alarm_IRQn, IRQ_PRIO_RTC, 0);
+	HAL_NVIC_EnableIRQ(RTC_Alarm_IRQn);
+}
+
+void rtc_clock_get(rtc_time_t *t)
+{
+	// TR을 먼저 읽어야 DR이 같은 시점 값으로 잠긴다
+	uint32_t tr = RTC->TR;
+	uint32_t dr = RTC->DR;
+
+	t->hour   = from_bcd(tr >> 16);
+	t->minute = from_bcd(tr >> 8);
+	t->second = from_bcd(tr);
+	t->year   = from_bcd(dr >> 16);
+	t->month  = from_bcd((dr >> 8) & 0x1F);
+	t->day    = from_bcd(dr & 0x3F);
+}
+
+bool rtc_clock_set(const rtc_time_t *t)
+{
+	if (t->year > 99 || t->day < 1 || t->day > rtc_days_in_month(t->year, t->month)
+	    || t->hour > 23 || t->minute > 59 || t->second > 59)
+	{
+		return false;
+	}
+
+	uint32_t tr = ((uint32_t)to_bcd(t->hour) << 16) | ((uint32_t)to_bcd(t->minute) << 8)
+	            | to_bcd(t->second);
+	uint32_t dr = ((uint32_t)to_bcd(t->year) << 16)
+	            | ((uint32_t)weekday(2000 + t->year, t->month, t->day) << RTC_DR_WDU_Pos)
+	            | ((uint32_t)to_bcd(t->month) << 8) | to_bcd(t->day);
+	bool ok;
+
+	rtc_unlock();
+	RTC->ISR |= RTC_ISR_INIT;
+	ok = wait_flag(&RTC->ISR, RTC_ISR_INITF, RTC_TIMEOUT_MS);
+
+	if (ok)
+	{
+		// 동기 분주를 먼저, 비동기 분주를 나중에 따로 써야 한다
+		RTC->PRER = prer_sync();
+		RTC->PRER |= PRER_ASYNC << 16;
+		RTC->TR = tr;
+		RTC->DR = dr;
+		RTC->CR &= ~RTC_CR_FMT;   // 24시간 형식
+	}
+
+	RTC->ISR &= ~RTC_ISR_INIT;
+	rtc_lock();
+
+	// 초기화 모드에서 나온 뒤 섀도 레지스터가 새 값으로 맞춰질 때까지 기다려야 바로 읽어도 맞다
+	if (ok) {
+		ok = wait_flag(&RTC->ISR, RTC_ISR_RSF, RTC_TIMEOUT_MS);
+	}
+	return ok;
+}
+
+// 매일 hour:minute:00 에 울리는 알람 (날짜 무시)
+void rtc_clock_set_alarm(uint8_t hour, uint8_t minute, rtc_alarm_cb_t cb)
+{
+	alarm_cb = cb;
+
+	rtc_unlock();
+	RTC->CR &= ~(RTC_CR_ALRAE | RTC_CR_ALRAIE);
+
+	if (wait_flag(&RTC->ISR, RTC_ISR_ALRAWF, RTC_TIMEOUT_MS))
+	{
+		RTC->ALRMAR = RTC_ALRMAR_MSK4
+		            | ((uint32_t)to_bcd(hour) << 16) | ((uint32_t)to_bcd(minute) << 8);
+		RTC->ISR = ~(RTC_ISR_ALRAF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+		RTC->CR |= RTC_CR_ALRAE | RTC_CR_ALRAIE;
+	}
+
+	rtc_lock();
+}
+
+void rtc_alarm_irq_handler(void)
+{
+	if (RTC->ISR & RTC_ISR_ALRAF)
+	{
+		RTC->ISR = ~(RTC_ISR_ALRAF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+
+		if (alarm_cb != NULL) {
+			alarm_cb();
+		}
+	}
+
+	EXTI->PR = EXTI_PR_PR17;
+}
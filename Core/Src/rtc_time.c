@@ -0,0 +1,42 @@
+// 달력 계산 (RTC 레지스터와 무관한 순수 로직)
+
+#include "rtc_time.h"
+
+// year는 2000년 기준 (0~99). 2000~2099에서는 4로 나누어떨어지면 윤년
+uint8_t rtc_days_in_month(uint8_t year, uint8_t month)
+{
+	static const uint8_t days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+	if (month < 1 || month > 12) {
+		return 0;
+	}
+	if (month == 2 && (year % 4) == 0) {
+		return 29;
+	}
+	return days[month - 1];
+}
+
+// 자정, 월말, 연말을 넘겨 가며 초를 더한다 (2099년 다음은 2000년)
+void rtc_time_add_seconds(rtc_time_t *t, uint32_t seconds)
+{
+	uint32_t sec = t->hour * 3600U + t->minute * 60U + t->second + seconds % 86400U;
+	uint32_t days = seconds / 86400U + sec / 86400U;
+
+	sec %= 86400U;
+	t->hour = (uint8_t)(sec / 3600U);
+	t->minute = (uint8_t)(sec / 60U % 60U);
+	t->second = (uint8_t)(sec % 60U);
+
+	while (days--)
+	{
+		if (++t->day > rtc_days_in_month(t->year, t->month))
+		{
+			t->day = 1;
+			if (++t->month > 12)
+			{
+				t->month = 1;
+				t->year = (uint8_t)((t->year + 1) % 100);
+			}
+		}
+	}
+}
@@ -0,0 +1,107 @@
+// USART2 한 줄 명령 콘솔 (폴링 방식)
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "uart_console.h"
+
+// 등록 가능한 명령 수
+#define MAX_COMMAND 16
+#define LINE_MAX 48
+
+extern UART_HandleTypeDef huart2;
+
+typedef struct {
+	const char *name;
+	console_cmd_t handler;
+} console_entry_t;
+
+static console_entry_t commands[MAX_COMMAND];
+static size_t command_count = 0;
+
+static char line[LINE_MAX];
+static size_t line_len = 0;
+
+void console_register(const char *name, console_cmd_t handler)
+{
+	for (size_t i = 0; i < command_count; ++i) {
+		if (strcmp(commands[i].name, name) == 0) {
+			commands[i].handler = handler;
+			return;
+		}
+	}
+
+	if (command_count < MAX_COMMAND)
+	{
+		commands[command_count].name = name;
+		commands[command_count].handler = handler;
+		command_count++;
+	}
+}
+
+static void console_dispatch(void)
+{
+	char *args = strchr(line, ' ');
+
+	if (args != NULL) {
+		*args++ = '\0';
+	}
+	else {
+		args = &line[line_len];
+	}
+
+	for (size_t i = 0; i < command_count; ++i) {
+		if (strcmp(commands[i].name, line) == 0) {
+			commands[i].handler(args);
+			return;
+		}
+	}
+
+	console_printf("unknown: %s\r\n", line);
+}
+
+// 메인 루프에서 호출. 수신된 문자가 없으면 바로 리턴
+void console_poll(void)
+{
+	while (__HAL_UART_GET_FLAG(&huart2, UART_FLAG_RXNE))
+	{
+		char c = (char)(huart2.Instance->DR & 0xFF);
+
+		if (c == '\r' || c == '\n')
+		{
+			if (line_len > 0) {
+				line[line_len] = '\0';
+				console_dispatch();
+				line_len = 0;
+			}
+		}
+		else if (line_len < LINE_MAX - 1)
+		{
+			line[line_len++] = c;
+		}
+	}
+}
+
+void console_write(const void *data, size_t len)
+{
+	HAL_UART_Transmit(&huart2, (const uint8_t *)data, (uint16_t)len, HAL_MAX_DELAY);
+}
+
+void console_printf(const char *format, ...)
+{
+	char buf[96];
+	va_list args;
+
+	va_start(args, format);
+	int len = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (len < 0) {
+		return;
+	}
+	if ((size_t)len >= sizeof(buf)) {
+		len = sizeof(buf) - 1;
+	}
+	console_write(buf, (size_t)len);
+}
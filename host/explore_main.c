@@ -0,0 +1,47 @@
+// 신호등 FSM 상태 공간 전수 탐색 (호스트)
+//
+// Core의 07_traffic_fsm.c와 07_traffic_explore.c를 고치지 않고 그대로 컴파일한다.
+// 결과를 한 번 출력한 뒤, 같은 탐색을 EXPLORE_BENCH_NS 동안 반복해 초당 상태 수를 잰다.
+// 위반이나 방문 집합 넘침이 있으면 1로 끝난다.
+
+#include <stdio.h>
+#include <time.h>
+#include "07_traffic_explore.h"
+
+#define EXPLORE_BENCH_NS 200000000ULL   // 0.2초
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+int main(void)
+{
+	explore_result_t result;
+	unsigned long long start, elapsed, states = 0;
+	unsigned long runs = 0;
+
+	traffic_explore_run(&result);
+	printf("explore: %lu states, %lu transitions, %lu violations (first %08lx)%s\n",
+	       (unsigned long)result.states, (unsigned long)result.transitions,
+	       (unsigned long)result.violations, (unsigned long)result.first_bad,
+	       result.overflow ? ", OVERFLOW" : "");
+
+	start = now_ns();
+	do {
+		explore_result_t r;
+
+		traffic_explore_run(&r);
+		states += r.states;
+		runs++;
+		elapsed = now_ns() - start;
+	} while (elapsed < EXPLORE_BENCH_NS);
+
+	printf("explore: %lu runs in %llu us, %llu states/s (capacity %u)\n", runs, elapsed / 1000,
+	       states * 1000000000ULL / elapsed, (unsigned)EXPLORE_CAPACITY);
+
+	return (result.violations || result.overflow) ? 1 : 0;
+}
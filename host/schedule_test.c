@@ -0,0 +1,185 @@
+// 스케줄 전환 테스트 (호스트, 가짜 RTC)
+//
+// Core의 07_traffic_schedule.c와 rtc_time.c를 그대로 컴파일하고 시계만 가짜로 바꾼다.
+// 가짜 시계는 1초씩 흐르며 RTC처럼 매일 hour:minute:00에 알람을 부른다.
+// 경계 2초 전에서 시작해 넘어가는 동안 알람, 날짜, 다시 걸린 알람을 본다.
+// 하나라도 틀리면 1로 끝난다.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "07_traffic_schedule.h"
+#include "rtc_time.h"
+
+#define CASE_WAIT_S 3
+
+static rtc_time_t fake_now;
+static bool alarm_on;
+static uint8_t alarm_hour, alarm_minute;
+static void (*alarm_cb)(void);
+
+static void fake_get(rtc_time_t *t)
+{
+	*t = fake_now;
+}
+
+static void fake_set_alarm(uint8_t hour, uint8_t minute, void (*cb)(void))
+{
+	alarm_hour = hour;
+	alarm_minute = minute;
+	alarm_cb = cb;
+	alarm_on = true;
+}
+
+static const schedule_clock_t fake_clock = {
+	.get = fake_get,
+	.set_alarm = fake_set_alarm,
+};
+
+static void fake_tick(void)
+{
+	rtc_time_add_seconds(&fake_now, 1);
+	if (alarm_on && fake_now.hour == alarm_hour && fake_now.minute == alarm_minute && fake_now.second == 0) {
+		alarm_cb();
+	}
+}
+
+static int failures;
+
+static void expect(bool ok, const char *what)
+{
+	printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+	if (!ok) {
+		failures++;
+	}
+}
+
+static bool same_time(const rtc_time_t *a, const rtc_time_t *b)
+{
+	return a->year == b->year && a->month == b->month && a->day == b->day
+	    && a->hour == b->hour && a->minute == b->minute && a->second == b->second;
+}
+
+static uint8_t plan_input(uint16_t minute)
+{
+	return (schedule_plan_at(minute) == PLAN_NIGHT) ? TL_IN_PLAN_NIGHT : TL_IN_PLAN_DAY;
+}
+
+typedef struct {
+	rtc_time_t start;
+	uint8_t year, month, day, hour;   // 대기 뒤 날짜와 시 (분은 0)
+	uint8_t before;                   // 시작 시각에서 올라오는 플랜 입력
+	uint8_t fired;                    // 대기 중 알람으로 들어오는 입력 (0이면 알람 없음)
+	uint16_t alarm;                   // 대기 뒤 걸려 있어야 하는 알람 (0시 기준 분)
+} rollover_case_t;
+
+static const rollover_case_t rollover_cases[] = {
+	{ { 26,  3, 14, 21, 59, 58 }, 26,  3, 14, 22, TL_IN_PLAN_DAY,   TL_IN_PLAN_NIGHT, 6 * 60 },
+	{ { 26,  5, 31,  5, 59, 58 }, 26,  5, 31,  6, TL_IN_PLAN_NIGHT, TL_IN_PLAN_DAY,   22 * 60 },
+	{ { 26,  1, 31, 23, 59, 58 }, 26,  2,  1,  0, TL_IN_PLAN_NIGHT, 0,                6 * 60 },
+	{ { 26,  4, 30, 23, 59, 58 }, 26,  5,  1,  0, TL_IN_PLAN_NIGHT, 0,                6 * 60 },
+	{ { 27,  2, 28, 23, 59, 58 }, 27,  3,  1,  0, TL_IN_PLAN_NIGHT, 0,                6 * 60 },
+	{ { 28,  2, 28, 23, 59, 58 }, 28,  2, 29,  0, TL_IN_PLAN_NIGHT, 0,                6 * 60 },
+	{ { 28,  2, 29, 23, 59, 58 }, 28,  3,  1,  0, TL_IN_PLAN_NIGHT, 0,                6 * 60 },
+	{ { 26, 12, 31, 23, 59, 58 }, 27,  1,  1,  0, TL_IN_PLAN_NIGHT, 0,                6 * 60 },
+	{ { 99, 12, 31, 23, 59, 58 },  0,  1,  1,  0, TL_IN_PLAN_NIGHT, 0,                6 * 60 },
+};
+
+static void run_rollover(const rollover_case_t *c)
+{
+	char what[64];
+	uint8_t before, fired = 0, after;
+	bool ok;
+
+	fake_now = c->start;
+	alarm_on = false;
+	schedule_start(&fake_clock);
+	before = schedule_take_input();
+
+	// 알람이 울리면 schedule_take_input이 다시 맞추고 새 플랜을 올린다
+	for (int s = 0; s < CASE_WAIT_S; ++s)
+	{
+		uint8_t input;
+
+		fake_tick();
+		input = schedule_take_input();
+		if (input != 0) {
+			fired = input;
+		}
+	}
+
+	ok = before == c->before && fired == c->fired
+	     && fake_now.year == c->year && fake_now.month == c->month && fake_now.day == c->day
+	     && fake_now.hour == c->hour && fake_now.minute == 0
+	     && alarm_on && alarm_hour * 60 + alarm_minute == c->alarm;
+
+	// 경계를 넘은 시각에서 처음부터 다시 맞춰도 같은 플랜과 알람이어야 한다
+	schedule_resync();
+	after = schedule_take_input();
+	ok = ok && after == plan_input(c->hour * 60) && alarm_hour * 60 + alarm_minute == c->alarm;
+
+	snprintf(what, sizeof(what), "rollover 20%02u-%02u-%02u %02u:59:58",
+	         c->start.year, c->start.month, c->start.day, c->start.hour);
+	expect(ok, what);
+}
+
+// 하루 종일 1초씩 돌리며 플랜 입력이 정확히 두 번(06:00, 22:00) 바뀌는지 본다
+static void run_full_day(void)
+{
+	uint8_t inputs[2];
+	int changes = 0;
+
+	fake_now = (rtc_time_t){ 26, 7, 1, 0, 0, 0 };
+	alarm_on = false;
+	schedule_start(&fake_clock);
+	schedule_take_input();
+
+	for (int s = 0; s < 86400; ++s)
+	{
+		uint8_t input;
+
+		fake_tick();
+		input = schedule_take_input();
+		if (input != 0)
+		{
+			if (changes < 2) {
+				inputs[changes] = input;
+			}
+			changes++;
+		}
+	}
+	expect(changes == 2 && inputs[0] == TL_IN_PLAN_DAY && inputs[1] == TL_IN_PLAN_NIGHT
+	       && fake_now.day == 2 && fake_now.hour == 0, "full day: two plan changes");
+}
+
+int main(void)
+{
+	rtc_time_t t;
+
+	expect(rtc_days_in_month(26, 2) == 28 && rtc_days_in_month(28, 2) == 29
+	       && rtc_days_in_month(0, 2) == 29 && rtc_days_in_month(26, 4) == 30
+	       && rtc_days_in_month(26, 12) == 31 && rtc_days_in_month(26, 0) == 0
+	       && rtc_days_in_month(26, 13) == 0, "month lengths");
+
+	expect(schedule_plan_at(0) == PLAN_NIGHT && schedule_plan_at(359) == PLAN_NIGHT
+	       && schedule_plan_at(360) == PLAN_DAY && schedule_plan_at(1319) == PLAN_DAY
+	       && schedule_plan_at(1320) == PLAN_NIGHT && schedule_plan_at(1439) == PLAN_NIGHT,
+	       "plan at boundaries");
+	expect(schedule_next_boundary(0) == 360 && schedule_next_boundary(359) == 360
+	       && schedule_next_boundary(360) == 1320 && schedule_next_boundary(1320) == 360
+	       && schedule_next_boundary(1439) == 360, "next boundary wraps past midnight");
+
+	t = (rtc_time_t){ 28, 2, 28, 23, 0, 0 };
+	rtc_time_add_seconds(&t, 2 * 3600);
+	expect(same_time(&t, &(rtc_time_t){ 28, 2, 29, 1, 0, 0 }), "add 2 h into leap day");
+	t = (rtc_time_t){ 28, 1, 1, 0, 0, 0 };
+	rtc_time_add_seconds(&t, 366U * 86400U);
+	expect(same_time(&t, &(rtc_time_t){ 29, 1, 1, 0, 0, 0 }), "add 366 days over leap year");
+
+	for (size_t i = 0; i < sizeof(rollover_cases) / sizeof(rollover_cases[0]); ++i) {
+		run_rollover(&rollover_cases[i]);
+	}
+	run_full_day();
+
+	printf("schedule_test: %s (%d failed)\n", failures ? "FAIL" : "PASS", failures);
+	return failures ? 1 : 0;
+}